@@ -122,17 +122,19 @@ struct StrTabList {
   uint32_t nextoffset;
 };
 
+#define SYMTABINITSIZE 0x400  /* initial symbols, doubled when needed */
+
 struct SymbolNode {
-  struct node n;
   struct SymbolNode *hashchain;
   const char *name;
-  struct nlist32 s;
   uint32_t index;
 };
 
 struct SymTabList {
-  struct list l;
-  struct SymbolNode **hashtab;
+  struct SymbolNode *nodes;     /* array of nodes, in symbol table order */
+  struct nlist32 *syms;         /* a.out symbols, in symbol table order */
+  struct SymbolNode **hashtab;  /* newest node first in a chain */
+  uint32_t htabsize;            /* power of 2, number of allocated nodes */
   uint32_t nextindex;
 };
 
@@ -165,6 +167,7 @@ void aout_initwrite(struct GlobalVars *,struct LinkedSection **);
 void aout_addsymlist(struct GlobalVars *,struct LinkedSection **,
                      uint8_t,uint8_t,int);
 void aout_debugsyms(struct GlobalVars *,bool);
+int aout_findsym(const char *,bool);
 uint32_t aout_addrelocs(struct GlobalVars *,struct LinkedSection **,int,
                       struct list *,
                       uint32_t (*getrinfo)(struct GlobalVars *,struct Reloc *,
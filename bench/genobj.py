@@ -0,0 +1,176 @@
+#!/usr/bin/env python3
+# genobj.py - generate synthetic ELF m68k objects and an archive
+# for benchmarking vlink (see "make bench").
+#
+# Every object gets a number of sections, alternating between code and
+# data, each defining global symbols and containing R_68K_32 relocations
+# to symbols of other objects and of the archive members. The first
+# object defines the entry point _start. Output is reproducible for the
+# same arguments.
+
+import argparse
+import os
+import random
+import struct
+
+EM_68K = 4
+R_68K_32 = 1
+SHT_PROGBITS, SHT_SYMTAB, SHT_STRTAB, SHT_RELA = 1, 2, 3, 4
+SHF_WRITE, SHF_ALLOC, SHF_EXECINSTR = 1, 2, 4
+STB_GLOBAL = 1
+STT_OBJECT, STT_FUNC = 1, 2
+
+
+class StrTab:
+    def __init__(self):
+        self.data = bytearray(b'\0')
+
+    def add(self, s):
+        off = len(self.data)
+        self.data += s.encode() + b'\0'
+        return off
+
+
+def elf_object(secs, syms, relocs):
+    """Return the image of a relocatable ELF object.
+       secs:   [(name, size, flags)]
+       syms:   [(name, secindex or 0, value)], all global
+       relocs: {secindex: [(offset, symname)]}, secindex is 1-based"""
+    strtab = StrTab()
+    symtab = bytearray(16)
+    symidx = {}
+    for i, (name, shndx, value) in enumerate(syms):
+        if shndx:
+            typ = STT_FUNC if secs[shndx-1][2] & SHF_EXECINSTR else STT_OBJECT
+        else:
+            typ = 0
+        symtab += struct.pack('>IIIBBH', strtab.add(name), value, 0,
+                              (STB_GLOBAL << 4) | typ, 0, shndx)
+        symidx[name] = i + 1
+
+    nsecs = len(secs)
+    shdrs = []  # (name, type, flags, data, link, info, align, entsize)
+    for name, size, flags in secs:
+        shdrs.append((name, SHT_PROGBITS, flags, bytes(size), 0, 0, 4, 0))
+    symsec = nsecs + len(relocs) + 1
+    for shndx in sorted(relocs):
+        data = bytearray()
+        for offset, sym in relocs[shndx]:
+            data += struct.pack('>IIi', offset,
+                                (symidx[sym] << 8) | R_68K_32, 0)
+        shdrs.append(('.rela' + secs[shndx-1][0], SHT_RELA, 0, bytes(data),
+                      symsec, shndx, 4, 12))
+    shdrs.append(('.symtab', SHT_SYMTAB, 0, bytes(symtab),
+                  symsec + 1, 1, 4, 16))
+    shdrs.append(('.strtab', SHT_STRTAB, 0, bytes(strtab.data), 0, 0, 1, 0))
+    shstrtab = StrTab()
+    shdrs.append(('.shstrtab', SHT_STRTAB, 0, None, 0, 0, 1, 0))
+
+    body = bytearray()
+    hdrs = [bytes(40)]
+    for name, typ, flags, data, link, info, align, entsize in shdrs:
+        nameoff = shstrtab.add(name)
+        if data is None:
+            data = bytes(shstrtab.data)
+        body += bytes(-(52 + len(body)) % 4)
+        hdrs.append(struct.pack('>IIIIIIIIII', nameoff, typ, flags, 0,
+                                52 + len(body), len(data), link, info,
+                                align, entsize))
+        body += data
+    body += bytes(-(52 + len(body)) % 4)
+    ident = b'\x7fELF' + bytes([1, 2, 1]) + bytes(9)
+    ehdr = ident + struct.pack('>HHIIIIIHHHHHH', 1, EM_68K, 1, 0, 0,
+                               52 + len(body), 0, 52, 0, 0, 40,
+                               len(hdrs), len(hdrs) - 1)
+    return ehdr + bytes(body) + b''.join(hdrs)
+
+
+def write_ar(path, members):
+    with open(path, 'wb') as f:
+        f.write(b'!<arch>\n')
+        for name, data in members:
+            hdr = '%-16s%-12d%-6d%-6d%-8o%-10d`\n' % (name + '/', 0, 0, 0,
+                                                       0o644, len(data))
+            f.write(hdr.encode() + data)
+            if len(data) & 1:
+                f.write(b'\n')
+
+
+def main():
+    ap = argparse.ArgumentParser(description='generate synthetic ELF '
+                                 'objects for benchmarking vlink')
+    ap.add_argument('-o', dest='outdir', default='bench/out',
+                    help='output directory (default: %(default)s)')
+    ap.add_argument('--objects', type=int, default=500)
+    ap.add_argument('--sections', type=int, default=8,
+                    help='sections per object')
+    ap.add_argument('--symbols', type=int, default=16,
+                    help='global symbols per section')
+    ap.add_argument('--relocs', type=int, default=32,
+                    help='relocations per section')
+    ap.add_argument('--members', type=int, default=200,
+                    help='members of the archive libbench.a')
+    ap.add_argument('--seed', type=int, default=1)
+    a = ap.parse_args()
+
+    rnd = random.Random(a.seed)
+    os.makedirs(a.outdir, exist_ok=True)
+    secsize = max(a.symbols * 16, a.relocs * 4)
+
+    def objsym(i, k, j):
+        return 'o%d_s%d_%d' % (i, k, j)
+
+    def libsym(m, j):
+        return 'l%d_%d' % (m, j)
+
+    def target():
+        # One in eight references goes to an archive member. The upper
+        # half of each object's sections is never referenced, which
+        # leaves something to remove for -gc-all.
+        if a.members and rnd.randrange(8) == 0:
+            return libsym(rnd.randrange(a.members), rnd.randrange(a.symbols))
+        return objsym(rnd.randrange(a.objects),
+                      rnd.randrange((a.sections + 1) // 2),
+                      rnd.randrange(a.symbols))
+
+    for i in range(a.objects):
+        secs, syms, relocs, undef = [], [], {}, set()
+        for k in range(a.sections):
+            if k & 1:
+                secs.append(('.data.%d' % k, secsize, SHF_ALLOC | SHF_WRITE))
+            else:
+                secs.append(('.text.%d' % k, secsize,
+                             SHF_ALLOC | SHF_EXECINSTR))
+            for j in range(a.symbols):
+                syms.append((objsym(i, k, j), k + 1, j * 16))
+            rl = []
+            for r in range(a.relocs):
+                sym = target()
+                if not sym.startswith('o%d_' % i):
+                    undef.add(sym)
+                rl.append((r * 4, sym))
+            if rl:
+                relocs[k + 1] = rl
+        if i == 0:
+            syms.append(('_start', 1, 0))
+        syms += [(s, 0, 0) for s in sorted(undef)]
+        with open(os.path.join(a.outdir, 'obj%d.o' % i), 'wb') as f:
+            f.write(elf_object(secs, syms, relocs))
+
+    members = []
+    for m in range(a.members):
+        # each member references its successor, to pull in chains
+        syms = [(libsym(m, j), 1, j * 16) for j in range(a.symbols)]
+        relocs = {}
+        if m + 1 < a.members:
+            syms.append((libsym(m + 1, 0), 0, 0))
+            relocs[1] = [(0, libsym(m + 1, 0))]
+        members.append(('lib%d.o' % m,
+                        elf_object([('.text', a.symbols * 16,
+                                     SHF_ALLOC | SHF_EXECINSTR)],
+                                   syms, relocs)))
+    write_ar(os.path.join(a.outdir, 'libbench.a'), members)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,317 @@
+/* $VER: vlink cache.c V0.17b (19.10.26)
+ *
+ * This file is part of vlink, a portable linker for multiple
+ * object formats.
+ * Copyright (c) 1997-2026  Frank Wille
+ */
+
+
+#define CACHE_C
+#include "vlink.h"
+
+#define CACHEBUFSIZE 0x4000     /* buffer for copying files */
+#define CACHEKEYLEN 32          /* hex digits of a cache key */
+#define CACHETMPGRACE 3600      /* age of an abandoned temporary file */
+
+
+/* 128-bit hash of everything which influences the output */
+static uint64_t key_fnv;        /* FNV-1a */
+static uint64_t key_mix;        /* multiply-rotate */
+static char keyname[CACHEKEYLEN+1];
+static long mapstart;           /* map file position before linker_resolve */
+static bool cacheable;
+
+
+static void hash_bytes(const void *p,size_t len)
+{
+  const uint8_t *s = (const uint8_t *)p;
+  uint64_t h1 = key_fnv;
+  uint64_t h2 = key_mix;
+
+  while (len--) {
+    h1 = (h1 ^ *s) * 0x100000001b3ULL;
+    h2 = (((h2 << 7) | (h2 >> 57)) ^ *s++) * 0x9e3779b97f4a7c15ULL;
+  }
+  key_fnv = h1;
+  key_mix = h2;
+}
+
+
+static void hash_string(const char *s)
+{
+  hash_bytes(s,strlen(s)+1);  /* including the 0-byte, as separator */
+}
+
+
+static void hash_ulong(unsigned long v)
+{
+  uint8_t buf[4];
+
+  write32be(buf,(uint32_t)v);
+  hash_bytes(buf,4);
+}
+
+
+static const char *cache_path(struct GlobalVars *gv,const char *ext)
+/* return path of the current key's cache file with extension */
+{
+  static char path[FNAMEBUFSIZE];
+  char name[CACHEKEYLEN+16];
+
+  snprintf(name,sizeof(name),"%s.%s",keyname,ext);
+  return path_append(path,gv->cache_dir,name,FNAMEBUFSIZE);
+}
+
+
+static void touch_entry(struct GlobalVars *gv,const char *ext)
+/* mark a cache file of the current key as recently used */
+{
+  const char *path = cache_path(gv,ext);
+
+  if (path)
+    touch_file(path);
+}
+
+
+static bool copy_stream(FILE *dst,FILE *src)
+{
+  char buf[CACHEBUFSIZE];
+  size_t n;
+
+  while ((n = fread(buf,1,CACHEBUFSIZE,src)) > 0) {
+    if (fwrite(buf,1,n,dst) != n)
+      return FALSE;
+  }
+  return !ferror(src);
+}
+
+
+static bool copy_file(const char *dstname,const char *srcname,long offs)
+/* copy file contents, starting at 'offs' in the source file */
+{
+  FILE *src,*dst;
+  bool ok = FALSE;
+
+  if (src = fopen(srcname,"rb")) {
+    if (fseek(src,offs,SEEK_SET) >= 0) {
+      if (dst = fopen(dstname,"wb")) {
+        ok = copy_stream(dst,src);
+        if (fclose(dst) != 0)
+          ok = FALSE;
+        if (!ok)
+          remove(dstname);
+      }
+    }
+    fclose(src);
+  }
+  return ok;
+}
+
+
+static bool store_file(struct GlobalVars *gv,const char *srcname,long offs,
+                       const char *ext)
+/* Copy a file into the cache. A temporary name is used while writing,
+   so concurrent vlink processes never see an incomplete entry. */
+{
+  char tmpname[FNAMEBUFSIZE];
+  char name[CACHEKEYLEN+32];
+  const char *path;
+
+  snprintf(name,sizeof(name),"%s.%lx.tmp",keyname,process_id());
+  if (path_append(tmpname,gv->cache_dir,name,FNAMEBUFSIZE) == NULL)
+    return FALSE;
+  if (!copy_file(tmpname,srcname,offs))
+    return FALSE;
+  path = cache_path(gv,ext);
+  if (path==NULL || rename(tmpname,path)!=0) {
+    /* entry may exist already, stored by another process */
+    remove(tmpname);
+    return FALSE;
+  }
+  return TRUE;
+}
+
+
+struct CacheEntry {
+  char *name;
+  unsigned long size;
+  unsigned long mtime;
+};
+
+static int cache_entry_cmp(const void *left,const void *right)
+/* qsort: compare modification times, oldest first */
+{
+  unsigned long t1 = ((const struct CacheEntry *)left)->mtime;
+  unsigned long t2 = ((const struct CacheEntry *)right)->mtime;
+
+  return t1<t2 ? -1 : (t1>t2 ? 1 : 0);
+}
+
+
+static void cache_trim(struct GlobalVars *gv)
+/* Delete the least recently used cache files, until the limit is no
+   longer exceeded. Temporary files, which are older than the entry
+   just stored by more than a grace period, were left by an aborted
+   vlink process and are deleted as well. */
+{
+  char path[FNAMEBUFSIZE];
+  struct CacheEntry *entries = NULL;
+  unsigned long total=0,size,mtime,now;
+  int i,n=0,max=0;
+  const char *name,*p;
+  char *d;
+
+  /* the output file was just stored, its time is the current time */
+  if ((p = cache_path(gv,"out"))==NULL || !file_info(p,&size,&now))
+    now = 0;
+
+  if ((d = open_dir(gv->cache_dir)) == NULL)
+    return;
+  while (name = read_dir(d)) {
+    if (strlen(name)<=CACHEKEYLEN || name[CACHEKEYLEN]!='.')
+      continue;  /* not a cache file */
+    if (path_append(path,gv->cache_dir,name,FNAMEBUFSIZE) == NULL ||
+        !file_info(path,&size,&mtime))
+      continue;
+    if (strchr(&name[CACHEKEYLEN+1],'.') != NULL) {
+      /* temporary file, which is still being written or abandoned */
+      if (!strcmp(strrchr(name,'.'),".tmp") && mtime+CACHETMPGRACE<now)
+        remove(path);
+      continue;
+    }
+    if (n >= max) {
+      max = max ? max<<1 : 64;
+      entries = re_alloc(entries,max*sizeof(struct CacheEntry));
+    }
+    entries[n].name = (char *)allocstring(name);
+    entries[n].size = size;
+    entries[n].mtime = mtime;
+    total += size;
+    n++;
+  }
+  close_dir(d);
+
+  if (total > gv->cache_limit) {
+    qsort(entries,n,sizeof(struct CacheEntry),cache_entry_cmp);
+    for (i=0; i<n && total>gv->cache_limit; i++) {
+      if (path_append(path,gv->cache_dir,entries[i].name,FNAMEBUFSIZE) &&
+          remove(path) == 0)
+        total -= entries[i].size;
+    }
+  }
+  for (i=0; i<n; i++)
+    free(entries[i].name);
+  free(entries);
+}
+
+
+bool cache_fetch(struct GlobalVars *gv,int argc,const char *argv[])
+/* Make the cache key from the command line, the target, the linker
+   script and the contents of all input files. When a cached output
+   file exists for this key, it is copied to the destination, together
+   with the map file, and TRUE is returned. */
+{
+  FILE *outf,*mapf=NULL,*destf;
+  struct LinkFile *lf;
+  const char *path;
+  bool ok = FALSE;
+  int i;
+
+  cacheable = gv->cache_dir!=NULL && !gv->output_sections &&
+              !(fff[gv->dest_format]->flags&(FFF_NOFILE|FFF_EXTRAFILES)) &&
+              gv->trace_file==NULL && gv->trace_syms==NULL &&
+              gv->vice_file==NULL && gv->csvmap_file==NULL &&
+              gv->debug_name==NULL &&
+              (gv->map_file==NULL || gv->map_name!=NULL);
+  if (!cacheable)
+    return FALSE;
+
+  key_fnv = 0xcbf29ce484222325ULL;
+  key_mix = 0x243f6a8885a308d3ULL;
+  hash_string(version_str);
+  hash_string(build_date);
+  hash_string(fff[gv->dest_format]->tname);
+  for (i=1; i<argc; i++) {
+    if (argv[i] == NULL)
+      continue;  /* -b options were deleted, target name is hashed */
+    if (!strcmp(argv[i],"-cache") || !strcmp(argv[i],"-cachesize"))
+      i++;  /* cache options don't change the output */
+    else if (!strncmp(argv[i],"-M",2))
+      hash_string("-M");  /* map contents don't depend on its name */
+    else if (strcmp(argv[i],"-time"))
+      hash_string(argv[i]);
+  }
+  if (gv->ldscript)
+    hash_string(gv->ldscript);
+  if (gv->symorder)
+    hash_string(gv->symorder);
+  for (lf=(struct LinkFile *)gv->linkfiles.first;
+       lf->n.next!=NULL; lf=(struct LinkFile *)lf->n.next) {
+    hash_string(lf->pathname);
+    hash_ulong(lf->length);
+    hash_bytes(lf->data,lf->length);
+  }
+  snprintf(keyname,sizeof(keyname),"%016llx%016llx",
+           (unsigned long long)key_fnv,(unsigned long long)key_mix);
+
+  if (gv->map_file) {
+    /* the map file is written from here on */
+    fflush(gv->map_file);
+    if ((mapstart = ftell(gv->map_file)) < 0) {
+      cacheable = FALSE;
+      return FALSE;
+    }
+  }
+
+  /* open all cached files first, as they might be trimmed by others */
+  if ((path = cache_path(gv,"out")) == NULL || !(outf = fopen(path,"rb")))
+    return FALSE;
+  if (gv->map_file) {
+    if ((path = cache_path(gv,"map")) != NULL)
+      mapf = fopen(path,"rb");
+    if (mapf == NULL) {
+      fclose(outf);
+      return FALSE;
+    }
+  }
+
+  if (destf = fopen(gv->dest_name,"wb")) {
+    ok = copy_stream(destf,outf);
+    if (fclose(destf) != 0)
+      ok = FALSE;
+    if (mapf!=NULL && ok)
+      ok = copy_stream(gv->map_file,mapf);
+    if (!ok)
+      error(154,gv->cache_dir);  /* fatal: output might be incomplete */
+    touch_entry(gv,"out");  /* cache_trim() deletes the oldest entries */
+    if (mapf)
+      touch_entry(gv,"map");
+    if (!gv->dest_sharedobj && !gv->dest_object)
+      set_exec(gv->dest_name);  /* set executable flag */
+  }
+  else
+    error(29,gv->dest_name);  /* Can't create output file */
+
+  fclose(outf);
+  if (mapf)
+    fclose(mapf);
+  return TRUE;
+}
+
+
+void cache_store(struct GlobalVars *gv)
+/* Put a successfully linked output file and its map file into the
+   cache. Links with warnings or errors are not cached, because the
+   messages would not be repeated on a cache hit. */
+{
+  if (!cacheable || gv->errflag || gv->returncode!=0 || gv->warncnt>0)
+    return;
+
+  if (gv->map_file) {
+    fflush(gv->map_file);
+    if (!store_file(gv,gv->map_name,mapstart,"map"))
+      return;
+  }
+  store_file(gv,gv->dest_name,0,"out");
+  cache_trim(gv);
+}
@@ -14,6 +14,7 @@
 #include <dos/dosextens.h>
 #include <dos/dostags.h>
 #include <proto/dos.h>
+#include <proto/exec.h>
 #pragma default-align
 
 struct Dir {
@@ -49,6 +50,8 @@ struct Dir {
 #include <sys/types.h>
 #include <dirent.h>
 #include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
 #endif
 
 
@@ -160,6 +163,46 @@ void set_exec(const char *path)
 }
 
 
+bool file_info(const char *path,unsigned long *size,unsigned long *mtime)
+/* get size and modification time (in seconds) of a file */
+{
+  struct FileInfoBlock *fib;
+  BPTR lock;
+  bool ok = FALSE;
+
+  if (fib = AllocDosObject(DOS_FIB,NULL)) {
+    if (lock = Lock(path,ACCESS_READ)) {
+      if (Examine(lock,fib)) {
+        *size = (unsigned long)fib->fib_Size;
+        *mtime = (unsigned long)fib->fib_Date.ds_Days*86400 +
+                 (unsigned long)fib->fib_Date.ds_Minute*60 +
+                 (unsigned long)fib->fib_Date.ds_Tick/TICKS_PER_SECOND;
+        ok = TRUE;
+      }
+      UnLock(lock);
+    }
+    FreeDosObject(DOS_FIB,fib);
+  }
+  return ok;
+}
+
+
+void touch_file(const char *path)
+/* set modification time of a file to the current time */
+{
+  struct DateStamp ds;
+
+  DateStamp(&ds);
+  SetFileDate(path,&ds);
+}
+
+
+unsigned long process_id(void)
+{
+  return (unsigned long)FindTask(NULL);
+}
+
+
 #elif defined(ATARI)
 
 char *open_dir(const char *dirname)
@@ -212,6 +255,45 @@ void set_exec(const char *path)
 }
 
 
+bool file_info(const char *path,unsigned long *size,unsigned long *mtime)
+/* get size and modification time (DOS date and time) of a file */
+{
+  DTA dta,*olddta;
+  bool ok = FALSE;
+
+  olddta = Fgetdta();
+  Fsetdta(&dta);
+  if (Fsfirst(path,FA_READONLY|FA_ARCHIVE) == E_OK) {
+    *size = (unsigned long)dta.d_length;
+    *mtime = ((unsigned long)dta.d_date << 16) | dta.d_time;
+    ok = TRUE;
+  }
+  Fsetdta(olddta);
+  return ok;
+}
+
+
+void touch_file(const char *path)
+/* set modification time of a file to the current time */
+{
+  DOSTIME dt;
+  long h;
+
+  if ((h = Fopen(path,FO_RW)) >= 0) {
+    dt.time = Tgettime();
+    dt.date = Tgetdate();
+    Fdatime(&dt,(int)h,1);
+    Fclose((int)h);
+  }
+}
+
+
+unsigned long process_id(void)
+{
+  return (unsigned long)Pgetpid();
+}
+
+
 #elif defined(_WIN32)
 
 char *open_dir(const char *dirname)
@@ -270,6 +352,44 @@ void set_exec(const char *path)
 }
 
 
+bool file_info(const char *path,unsigned long *size,unsigned long *mtime)
+/* get size and modification time (in seconds) of a file */
+{
+  WIN32_FILE_ATTRIBUTE_DATA fad;
+  ULARGE_INTEGER t;
+
+  if (!GetFileAttributesEx(path,GetFileExInfoStandard,&fad))
+    return FALSE;
+  t.LowPart = fad.ftLastWriteTime.dwLowDateTime;
+  t.HighPart = fad.ftLastWriteTime.dwHighDateTime;
+  *size = (unsigned long)fad.nFileSizeLow;
+  *mtime = (unsigned long)(t.QuadPart / 10000000);  /* 100ns units */
+  return TRUE;
+}
+
+
+void touch_file(const char *path)
+/* set modification time of a file to the current time */
+{
+  HANDLE h;
+  FILETIME ft;
+
+  h = CreateFile(path,FILE_WRITE_ATTRIBUTES,FILE_SHARE_READ|FILE_SHARE_WRITE,
+                 NULL,OPEN_EXISTING,FILE_ATTRIBUTE_NORMAL,NULL);
+  if (h != INVALID_HANDLE_VALUE) {
+    GetSystemTimeAsFileTime(&ft);
+    SetFileTime(h,NULL,NULL,&ft);
+    CloseHandle(h);
+  }
+}
+
+
+unsigned long process_id(void)
+{
+  return (unsigned long)GetCurrentProcessId();
+}
+
+
 #else /* UNIX */
 
 char *open_dir(const char *dirname)
@@ -303,4 +423,30 @@ void set_exec(const char *path)
   chmod(path,0755);  /* rwxr-xr-x */
 }
 
+
+bool file_info(const char *path,unsigned long *size,unsigned long *mtime)
+/* get size and modification time (in seconds) of a file */
+{
+  struct stat st;
+
+  if (stat(path,&st) != 0)
+    return FALSE;
+  *size = (unsigned long)st.st_size;
+  *mtime = (unsigned long)st.st_mtime;
+  return TRUE;
+}
+
+
+void touch_file(const char *path)
+/* set modification time of a file to the current time */
+{
+  utime(path,NULL);
+}
+
+
+unsigned long process_id(void)
+{
+  return (unsigned long)getpid();
+}
+
 #endif
@@ -27,6 +27,8 @@ struct list elfdynsymlist;
 
 struct Section *elfdynrelocs;
 struct Section *elfpltrelocs;
+struct Section *elfrelrrelocs;
+unsigned long elfrelcount;      /* relative relocations in .rel(a).dyn */
 
 uint32_t elfshdridx,elfsymtabidx,elfshstrtabidx,elfstrtabidx;
 uint32_t elfoffset;             /* current ELF file offset */
@@ -41,6 +43,7 @@ const char dynsym_name[] = ".dynsym";
 const char dynstr_name[] = ".dynstr";
 const char *dynrel_name[2] = { ".rel.dyn",".rela.dyn" };
 const char *pltrel_name[2] = { ".rel.plt",".rela.plt" };
+const char relr_name[] = ".relr.dyn";
 
 
 /* local static data */
@@ -49,6 +52,17 @@ static struct Section *gotsec;
 static struct Section *pltsec;
 static int secsyms;  /* offset to find section symbols by shndx */
 
+/* GOT/PLT entries, indexed by table section and referenced location */
+struct TabSlot {
+  struct TabSlot *next;
+  struct Section *tabsec;
+  struct Section *refsec;
+  unsigned long refoffs;
+  struct Symbol *sym;
+};
+static struct TabSlot **slot_htab;
+static unsigned long slot_hmask,slot_cnt;
+
 static char ELFid[4] = {   /* identification for all ELF files */
   0x7f,'E','L','F'
 };
@@ -512,11 +526,24 @@ void elf_dynreloc(struct GlobalVars *gv,struct ObjectUnit *ou,
       dynflag = SYMF_DYNEXPORT;
       /* fall through */
     case R_GLOBDAT:
-    case R_LOADREL:
       secp = &elfdynrelocs;
       secname = dynrel_name[relafmt?1:0];
       r->flags |= RELF_DYN;
       break;
+    case R_LOADREL:
+      if (gv->dynreloc_format == DYNREL_RELR) {
+        /* packed into .relr.dyn, which is sized by elf_relrsize() */
+        secp = &elfrelrrelocs;
+        secname = relr_name;
+        elfrelsize = 0;
+      }
+      else {
+        secp = &elfdynrelocs;
+        secname = dynrel_name[relafmt?1:0];
+        elfrelcount++;
+      }
+      r->flags |= RELF_DYN;
+      break;
     case R_JMPSLOT:
       secp = &elfpltrelocs;
       secname = pltrel_name[relafmt?1:0];
@@ -586,6 +613,58 @@ struct Section *elf_initdynlink(struct GlobalVars *gv)
 }
 
 
+static unsigned long slot_hash(struct Section *tabsec,struct Section *refsec,
+                               unsigned long refoffs)
+{
+  uintptr_t h = ((uintptr_t)tabsec >> 4) * 31 + ((uintptr_t)refsec >> 4);
+
+  return (unsigned long)((h * 0x9e3779b1UL + refoffs) ^ (h >> 16));
+}
+
+
+static struct TabSlot **find_slot(struct Section *tabsec,
+                                  struct Section *refsec,
+                                  unsigned long refoffs)
+/* return pointer to the slot's hash chain link, *link is NULL when unknown */
+{
+  struct TabSlot **chain,*ts;
+
+  chain = &slot_htab[slot_hash(tabsec,refsec,refoffs) & slot_hmask];
+  while (ts = *chain) {
+    if (ts->tabsec==tabsec && ts->refsec==refsec && ts->refoffs==refoffs)
+      break;
+    chain = &ts->next;
+  }
+  return chain;
+}
+
+
+static void grow_slots(void)
+/* double the size of the slot hash table */
+{
+  struct TabSlot **old = slot_htab;
+  struct TabSlot *ts,*next;
+  unsigned long i,oldmask = slot_hmask;
+
+  slot_hmask = oldmask ? (oldmask << 1) | 1 : 0xff;
+  slot_htab = alloc_hashtable(slot_hmask + 1);
+  if (old) {
+    for (i=0; i<=oldmask; i++) {
+      for (ts=old[i]; ts; ts=next) {
+        struct TabSlot **chain;
+
+        next = ts->next;
+        chain = &slot_htab[slot_hash(ts->tabsec,ts->refsec,ts->refoffs)
+                           & slot_hmask];
+        ts->next = *chain;
+        *chain = ts;
+      }
+    }
+    free(old);
+  }
+}
+
+
 struct Symbol *elf_pltgotentry(struct GlobalVars *gv,struct Section *sec,
                                DynArg a,uint8_t entrysymtype,
                                unsigned long offsadd,unsigned long sizeadd,
@@ -596,62 +675,68 @@ struct Symbol *elf_pltgotentry(struct GlobalVars *gv,struct Section *sec,
    The entry has a size of offsadd bytes, while the table section sec will
    become sizeadd bytes larger per entry. */
 {
-  const char *fn = "elf_pltgotentry():";
+  static uint8_t dyn_reloc_types[] = { R_NONE,R_GLOBDAT,R_JMPSLOT,R_COPY };
   char entryname[MAXLEN];
+  struct TabSlot **link,*ts;
   struct Symbol *tabsym;
   struct Section *refsec;
   unsigned long refoffs;
+  struct Reloc *r;
 
   /* determine reference section and offset of ext. symbol or local reloc */
   if (etype == GOT_LOCAL) {
     refsec = a.rel->relocsect.ptr;
-    refoffs = a.rel->offset;
+    refoffs = (unsigned long)a.rel->addend;
   }
   else {
     refsec = a.sym->relsect;
     refoffs = (unsigned long)a.sym->value;
   }
 
-  /* generate internal symbol name for this reference */
+  /* return the entry's symbol, when already present */
+  if (slot_cnt >= slot_hmask)
+    grow_slots();
+  link = find_slot(sec,refsec,refoffs);
+  if (*link)
+    return (*link)->sym;
+
+  /* create internal symbol for this reference, once */
   snprintf(entryname,MAXLEN," %s@%lx@%lx",
            sec->name,(unsigned long)refsec,refoffs);
-
-  /* create internal symbol, or return old one, when already present */
-  tabsym = addsymbol(gv,sec,allocstring(entryname),NULL,(lword)sec->offset,
-                     SYM_RELOC,0,entrysymtype,SYMB_LOCAL,offsadd,FALSE);
-
-  /* tabsym is NULL when it was just created, otherwise we already got it */
-  if (tabsym == NULL) {
-    static uint8_t dyn_reloc_types[] = { R_NONE,R_GLOBDAT,R_JMPSLOT,R_COPY };
-    struct Reloc *r;
-
-    tabsym = findlocsymbol(gv,sec->obj,entryname);
-    if (tabsym == NULL) {
-      ierror("%s %s-symbol referring to %s+%lx disappeared",
-             fn,sec->name,refsec->name,refoffs);
-    }
-
-    /* create a relocation for the new entry */
-    if (etype == GOT_LOCAL) {
-      /* local symbol: GOT relocation can be resolved now */
-      r = newreloc(gv,sec,NULL,refsec,0,sec->offset,R_ABS,(lword)refoffs);
-    }
-    else {
-      /* we need a dynamic linker relocation at the entry's offset */
-      r = newreloc(gv,sec,a.sym->name,NULL,0,sec->offset,
-                   dyn_reloc_types[etype],0);
-      r->relocsect.symbol = a.sym;  /* resolve with external symbol */
-      /* Possible enhancement: Find out whether referenced symbol resides
-         in an uninitialized section, without a relocation, then we don't
-         need an R_COPY relocation either! */
-    }
-    addreloc(sec,r,0,addrsize,-1);  /* size,mask only important for R_ABS */
-    elf_dynreloc(gv,gv->dynobj,r,relaflag,relocsize);
-
-    /* increase offset and size counters of table-section */
-    sec->offset += offsadd;
-    sec->size += sizeadd;
+  tabsym = adduniqsymbol(gv,sec,allocstring(entryname),(lword)sec->offset,
+                         SYM_RELOC,entrysymtype,offsadd);
+
+  ts = alloc(sizeof(struct TabSlot));
+  ts->next = NULL;
+  ts->tabsec = sec;
+  ts->refsec = refsec;
+  ts->refoffs = refoffs;
+  ts->sym = tabsym;
+  *link = ts;
+  slot_cnt++;
+
+  /* create a relocation for the new entry */
+  if (etype == GOT_LOCAL) {
+    /* local symbol: GOT relocation can be resolved now, but a shared
+       object needs a relative relocation for its load address */
+    r = newreloc(gv,sec,NULL,refsec,0,sec->offset,
+                 gv->dest_sharedobj?R_LOADREL:R_ABS,(lword)refoffs);
   }
+  else {
+    /* we need a dynamic linker relocation at the entry's offset */
+    r = newreloc(gv,sec,a.sym->name,NULL,0,sec->offset,
+                 dyn_reloc_types[etype],0);
+    r->relocsect.symbol = a.sym;  /* resolve with external symbol */
+    /* Possible enhancement: Find out whether referenced symbol resides
+       in an uninitialized section, without a relocation, then we don't
+       need an R_COPY relocation either! */
+  }
+  addreloc(sec,r,0,addrsize,-1);  /* size,mask only important for R_ABS */
+  elf_dynreloc(gv,gv->dynobj,r,relaflag,relocsize);
+
+  /* increase offset and size counters of table-section */
+  sec->offset += offsadd;
+  sec->size += sizeadd;
 
   return tabsym;
 }
@@ -684,6 +769,77 @@ struct Symbol *elf_bssentry(struct GlobalVars *gv,const char *secname,
 }
 
 
+static unsigned long relr_encode(struct GlobalVars *gv,struct SortKey *addr,
+                                 unsigned long n,uint8_t *dst)
+/* Encode sorted addresses of relative relocations as RELR entries:
+   an address, followed by bitmaps for the next 31 (63) words each.
+   Returns the number of entries. They are only counted, when dst is NULL. */
+{
+  unsigned long w = gv->tbytes_per_taddr;
+  unsigned long nbits = gv->bits_per_taddr - 1;
+  unsigned long i=0,cnt=0;
+  uint64_t base,bitmap,d;
+
+  while (i < n) {
+    if (dst)
+      writetaddr(gv,dst,cnt*w,(lword)addr[i].key);
+    cnt++;
+    base = addr[i++].key + w;
+    for (;;) {
+      bitmap = 0;
+      while (i<n && (d = addr[i].key-base) < nbits*w && d%w==0) {
+        bitmap |= (uint64_t)1 << (d/w);
+        i++;
+      }
+      if (bitmap == 0)
+        break;
+      if (dst)
+        writetaddr(gv,dst,cnt*w,(lword)((bitmap<<1)|1));
+      cnt++;
+      base += nbits * w;
+    }
+  }
+  return cnt;
+}
+
+
+void elf_relrsize(struct GlobalVars *gv)
+/* Set the size of .relr.dyn from the offsets of the relative relocations
+   in the dynamic sections. Each section is encoded separately, plus one
+   entry for a possibly different encoding after the previous section. */
+{
+  if (elfrelrrelocs) {
+    unsigned long n,max=0,cnt=0;
+    struct SortKey *addr = NULL;
+    struct Section *sec;
+    struct Reloc *r;
+
+    for (sec=(struct Section *)gv->dynobj->sections.first;
+         sec->n.next!=NULL; sec=(struct Section *)sec->n.next) {
+      for (n=0,r=(struct Reloc *)sec->relocs.first;
+           r->n.next!=NULL; r=(struct Reloc *)r->n.next) {
+        if ((r->flags & RELF_DYN) && r->rtype==R_LOADREL) {
+          if (n >= max) {
+            max = max ? max<<1 : 64;
+            addr = re_alloc(addr,max*sizeof(struct SortKey));
+          }
+          addr[n].key = r->offset;
+          addr[n++].ptr = r;
+        }
+      }
+      if (n) {
+        radix_sort(addr,n);
+        if (cnt)
+          cnt++;
+        cnt += relr_encode(gv,addr,n,NULL);
+      }
+    }
+    free(addr);
+    elfrelrrelocs->size = cnt * gv->tbytes_per_taddr;
+  }
+}
+
+
 size_t elf_num_buckets(size_t symcount)
 /* determine optimal number of buckets in dynamic symbol hash table */
 {
@@ -700,15 +856,9 @@ size_t elf_num_buckets(size_t symcount)
 
 
 void elf_putsymtab(uint8_t *p,struct SymTabList *sl)
-/* write all SymTabList nodes sequentially into memory */
+/* copy the whole symbol table into memory */
 {
-  size_t sz = sl->elfsymsize;
-  struct SymbolNode *sym;
-
-  while (sym = (struct SymbolNode *)remhead(&sl->l)) {
-    memcpy(p,sym->elfsym,sz);
-    p += sz;
-  }
+  memcpy(p,sl->elfsyms,sl->nextindex*sl->elfsymsize);
 }
 
 
@@ -882,31 +1032,50 @@ uint32_t elf_adddynstr(const char *s)
 }
 
 
+static void elf_growsymlist(struct SymTabList *sl,size_t newsize)
+/* Resize the node and symbol arrays to newsize entries and rebuild the
+   hash table with newsize buckets, which must be a power of two. */
+{
+  struct SymbolNode *sn,**chain;
+  uint32_t i;
+
+  sl->htabsize = newsize;
+  sl->nodes = re_alloc(sl->nodes,newsize*sizeof(struct SymbolNode));
+  sl->elfsyms = re_alloc(sl->elfsyms,newsize*sl->elfsymsize);
+  free(sl->hashtab);
+  sl->hashtab = alloczero(newsize*sizeof(struct SymbolNode *));
+
+  for (i=0,sn=sl->nodes; i<sl->nextindex; i++,sn++) {
+    chain = &sl->hashtab[elf_hash(sn->name) & (newsize-1)];
+    sn->hashchain = *chain;
+    *chain = sn;
+  }
+}
+
+
 uint32_t elf_addsym(struct SymTabList *sl,const char *name,uint64_t value,
                     uint64_t size,uint8_t bind,uint8_t type,uint16_t shndx)
 {
   struct SymbolNode **chain,*sn;
-  void *sym;
 
   if (name == NULL)  /* do nothing, return first index */
     return 0;
 
-  chain = &sl->hashtab[elf_hash(name) % sl->htabsize];
-
-  while (sn = *chain)
-    chain = &sn->hashchain;
+  if (sl->nextindex >= sl->htabsize)
+    elf_growsymlist(sl,sl->htabsize<<1);
 
-  /* new symbol table entry */
-  *chain = sn = alloc(sizeof(struct SymbolNode));
-  sn->hashchain = NULL;
+  /* new symbol table entry, inserted at the head of its hash chain */
+  chain = &sl->hashtab[elf_hash(name) & (sl->htabsize-1)];
+  sn = &sl->nodes[sl->nextindex];
+  sn->hashchain = *chain;
+  *chain = sn;
   sn->name = name;
   sn->index = sl->nextindex++;
   sn->shndx = shndx;
-  sn->elfsym = sym = alloc(sl->elfsymsize);
-  addtail(&sl->l,&sn->n);
 
   /* initialize ELF symbol */
-  sl->initsym(sym,elf_addstrlist(sl->strlist,name),value,size,
+  sl->initsym(sl->elfsyms + sn->index*sl->elfsymsize,
+              elf_addstrlist(sl->strlist,name),value,size,
               bind,type,shndx,elf_endianness==_BIG_ENDIAN_);
 
   return sn->index;
@@ -917,48 +1086,51 @@ void elf_initsymlist(struct SymTabList *sl,struct StrTabList *strl,
                      size_t tabsize,size_t symsize,
                      void (*init)(void *,uint32_t,uint64_t,uint64_t,
                                   uint8_t,uint8_t,uint16_t,bool))
+/* tabsize is the initial number of symbols and must be a power of 2 */
 {
-  initlist(&sl->l);
-  sl->htabsize = tabsize;
-  sl->hashtab = alloczero(tabsize * sizeof(struct SymbolNode *));
-  sl->strlist = strl;
+  sl->nodes = NULL;
+  sl->elfsyms = NULL;
+  sl->hashtab = NULL;
+  sl->nextindex = 0;
   sl->elfsymsize = symsize;
+  elf_growsymlist(sl,tabsize);
+  sl->strlist = strl;
   sl->initsym = init;
-  sl->nextindex = sl->globalindex = 0;
+  sl->globalindex = 0;
   elf_addsym(sl,noname,0,0,0,0,SHN_UNDEF);
 }
 
 
 struct SymbolNode *elf_findSymNode(struct SymTabList *sl,const char *name)
-/* Find an ELF symbol node by its name.
+/* Find the first ELF symbol node with this name. Chains start with the
+   newest node, so the last match is taken.
    Return pointer to it, or NULL when not found. */
 {
-  struct SymbolNode **chain = &sl->hashtab[elf_hash(name) % sl->htabsize];
-  struct SymbolNode *sym;
+  struct SymbolNode *sym,*found=NULL;
 
-  while (sym = *chain) {
+  for (sym=sl->hashtab[elf_hash(name) & (sl->htabsize-1)]; sym;
+       sym=sym->hashchain) {
     if (!strcmp(name,sym->name))
-      return sym;
-    chain = &sym->hashchain;
+      found = sym;
   }
-  return NULL;
+  return found;
 }
 
 
 static uint32_t elf_findsymidx(struct SymTabList *sl,const char *name,
                                uint16_t shndx)
-/* find an ELF symbol by its name and shndx */
+/* find the first ELF symbol with this name and shndx */
 /* return its symbol table index, index=0 means 'not found' */
 {
-  struct SymbolNode **chain = &sl->hashtab[elf_hash(name) % sl->htabsize];
   struct SymbolNode *sym;
+  uint32_t idx = 0;
 
-  while (sym = *chain) {
+  for (sym=sl->hashtab[elf_hash(name) & (sl->htabsize-1)]; sym;
+       sym=sym->hashchain) {
     if (!strcmp(name,sym->name) && sym->shndx==shndx)
-      return sym->index;
-    chain = &sym->hashchain;
+      idx = sym->index;
   }
-  return 0;
+  return idx;
 }
 
 
@@ -1041,13 +1213,38 @@ static uint16_t conv_perm_to_elf(uint8_t secperm)
 }
 
 
+static void hugepage_pad(struct GlobalVars *gv,struct Phdr *p,
+                         struct LinkedSection *lastsec)
+/* Pad a segment up to the next huge page boundary, so the kernel can
+   back its last part with a huge page, too. Impossible when another
+   section is located in the padding area. */
+{
+  lword hpmask = (1L << HUGEPAGE_ALIGN) - 1;
+  lword end = (p->mem_end + hpmask) & ~hpmask;
+  struct LinkedSection *ls;
+
+  if (end == p->mem_end)
+    return;
+  for (ls=(struct LinkedSection *)gv->lnksec.first;
+       ls->n.next!=NULL; ls=(struct LinkedSection *)ls->n.next) {
+    if ((ls->flags & SF_ALLOC) && ls->size &&
+        (lword)ls->copybase+ls->size > p->mem_end &&
+        (lword)ls->copybase < end)
+      return;
+  }
+  lastsec->gapsize += end - p->mem_end;
+  p->file_end = p->mem_end = end;
+}
+
+
 uint32_t elf_segmentcheck(struct GlobalVars *gv,size_t ehdrsize)
 /* 1. checks the PT_LOAD segments for intermediate uninitialized sections,
       which will be turned into initialized PROGBITS data sections
    2. sets segment permissions from contained sections
    3. calculates bytes to insert at beginning of segment to meet
       page-alignment restrictions
-   4. initializes PT_PHDR segment
+   4. pads read-only segments to a huge page boundary (-hugepages)
+   5. initializes PT_PHDR segment
    Returns number of segments in list */
 {
   unsigned long headersize = fff[gv->dest_format]->headersize(gv);
@@ -1157,6 +1354,10 @@ uint32_t elf_segmentcheck(struct GlobalVars *gv,size_t ehdrsize)
       if (seg_lastdat)
         p->file_end = seg_lastdat->copybase + seg_lastdat->filesize;
 
+      if (gv->huge_pages && !(p->flags & PF_W) && seg_lastdat!=NULL &&
+          p->file_end==p->mem_end)
+        hugepage_pad(gv,p,seg_lastdat);
+
       foffs += p->alignment_gap;
       p->offset = foffs;
       foffs += p->file_end - p->start;
@@ -1396,10 +1597,11 @@ void elf_initsymtabs(size_t symsize,
                                   uint8_t,uint8_t,uint16_t,bool))
 {
   if (elfsymlist.htabsize == 0)
-    elf_initsymlist(&elfsymlist,&elfstringlist,SYMHTABSIZE,symsize,init);
+    elf_initsymlist(&elfsymlist,&elfstringlist,SYMTABINITSIZE,symsize,init);
 
   if (elfdsymlist.htabsize == 0)
-    elf_initsymlist(&elfdsymlist,&elfdstrlist,DYNSYMHTABSIZE,symsize,init);
+    elf_initsymlist(&elfdsymlist,&elfdstrlist,DYNSYMTABINITSIZE,symsize,
+                    init);
 }
 
 
@@ -1476,11 +1678,7 @@ void elf_writestrtab(FILE *f,struct StrTabList *sl)
 
 void elf_writesymtab(FILE *f,struct SymTabList *sl)
 {
-  size_t sz = sl->elfsymsize;
-  struct SymbolNode *sym;
-
-  while (sym = (struct SymbolNode *)remhead(&sl->l))
-    fwritex(f,sym->elfsym,sz);
+  fwritex(f,sl->elfsyms,sl->nextindex*sl->elfsymsize);
 }
 
 
@@ -1494,4 +1692,361 @@ void elf_writerelocs(FILE *f,struct RelocList *rl)
 }
 
 
+struct DynRelocRef *elf_dynrelocs(struct GlobalVars *gv,unsigned long *cnt)
+/* Remove all relocations for .rel(a).dyn from the linked sections and
+   return them in an array, sorted when requested by the user. */
+{
+  struct DynRelocRef *drr = NULL,*sorted;
+  struct SortKey *keys;
+  struct LinkedSection *ls;
+  struct Reloc *rel,*nextrel;
+  struct list *l;
+  unsigned long i,n=0,max=0;
+
+  for (ls=(struct LinkedSection *)gv->lnksec.first;
+       ls->n.next!=NULL; ls=(struct LinkedSection *)ls->n.next) {
+    for (l=&ls->xrefs; l!=NULL; l=(l==&ls->xrefs)?&ls->relocs:NULL) {
+      for (rel=(struct Reloc *)l->first;
+           nextrel=(struct Reloc *)rel->n.next; rel=nextrel) {
+        if (!(rel->flags & RELF_DYN))
+          continue;
+        if (n >= max) {
+          max = max ? max<<1 : 64;
+          drr = re_alloc(drr,max*sizeof(struct DynRelocRef));
+        }
+        drr[n].ls = ls;
+        drr[n].rel = rel;
+        drr[n].symidx = 0;
+        if (rel->xrefname) {
+          struct SymbolNode *sn = elf_findSymNode(&elfdsymlist,rel->xrefname);
+
+          if (sn)  /* otherwise reported while writing the relocation */
+            drr[n].symidx = sn->index;
+        }
+        n++;
+        remnode(&rel->n);
+      }
+    }
+  }
+
+  if (gv->dynreloc_format!=DYNREL_UNSORTED && n>1) {
+    /* relative relocations first, then by symbol index and address:
+       sort by address, then stable by symbol index */
+    keys = alloc(n*sizeof(struct SortKey));
+    for (i=0; i<n; i++) {
+      keys[i].key = drr[i].ls->base + drr[i].rel->offset;
+      keys[i].ptr = &drr[i];
+    }
+    radix_sort(keys,n);
+    for (i=0; i<n; i++)
+      keys[i].key = ((struct DynRelocRef *)keys[i].ptr)->symidx;
+    radix_sort(keys,n);
+    sorted = alloc(max*sizeof(struct DynRelocRef));
+    for (i=0; i<n; i++)
+      sorted[i] = *(struct DynRelocRef *)keys[i].ptr;
+    free(keys);
+    free(drr);
+    drr = sorted;
+  }
+  *cnt = n;
+  return drr;
+}
+
+
+void elf_putrelr(struct GlobalVars *gv)
+/* Write the relative relocations packed into .relr.dyn. Their addends
+   are stored in the relocated words. Unused entries at the end are
+   filled with empty bitmaps. */
+{
+  if (elfrelrrelocs) {
+    const char *fn = "elf_putrelr():";
+    unsigned long i,w,n=0,max=0;
+    struct SortKey *addr = NULL;
+    struct LinkedSection *relr,*ls;
+    struct Reloc *rel,*nextrel;
+
+    if ((relr = find_lnksec(gv,relr_name,0,0,0,0)) == NULL)
+      ierror("%s %s lost",fn,relr_name);
+    w = gv->tbytes_per_taddr;
+
+    for (ls=(struct LinkedSection *)gv->lnksec.first;
+         ls->n.next!=NULL; ls=(struct LinkedSection *)ls->n.next) {
+      for (rel=(struct Reloc *)ls->relocs.first;
+           nextrel=(struct Reloc *)rel->n.next; rel=nextrel) {
+        if ((rel->flags & RELF_DYN) && rel->rtype==R_LOADREL) {
+          if (n >= max) {
+            max = max ? max<<1 : 64;
+            addr = re_alloc(addr,max*sizeof(struct SortKey));
+          }
+          addr[n].key = ls->base + rel->offset;
+          addr[n].ptr = rel;
+          if (addr[n].key & (w-1))
+            ierror("%s relative relocation at 0x%llx is not aligned",
+                   fn,(unsigned long long)addr[n].key);
+          writesection(gv,ls->data,rel->offset,rel,
+                       (lword)rel->relocsect.lnk->base+rel->addend);
+          n++;
+          remnode(&rel->n);
+        }
+      }
+    }
+
+    radix_sort(addr,n);
+    i = relr_encode(gv,addr,n,NULL);
+    if (i*w > relr->size)
+      ierror("%s %lu entries exceed %s size",fn,i,relr_name);
+    relr_encode(gv,addr,n,relr->data);
+    for (; i*w<relr->size; i++)
+      writetaddr(gv,relr->data,i*w,1);
+    free(addr);
+  }
+}
+
+
+/* Split debug information */
+
+struct SplitShdr {
+  uint32_t name,type,link,info;
+  uint64_t flags,offset,size,align;
+  uint32_t newidx;              /* index in stripped file, 0 for removed */
+  uint32_t newname;             /* name offset in new .shstrtab */
+  uint64_t newoffset;           /* file offset in stripped file */
+};
+
+/* access a field of an ELF32 or ELF64 header structure */
+#define ELFFLD(t,p,f) (is64 ? (void *)((struct Elf64_##t *)(p))->f : \
+                              (void *)((struct Elf32_##t *)(p))->f)
+
+
+static uint64_t read_addr(bool be,bool is64,void *p)
+{
+  return is64 ? read64(be,p) : (uint64_t)read32(be,p);
+}
+
+
+static void write_addr(bool be,bool is64,void *p,uint64_t v)
+{
+  if (is64)
+    write64(be,p,v);
+  else
+    write32(be,p,(uint32_t)v);
+}
+
+
+static uint32_t debuglink_crc(uint8_t *p,unsigned long len)
+/* CRC-32 (ISO 3309), as required for the .gnu_debuglink checksum */
+{
+  static uint32_t tab[256];
+  uint32_t crc;
+  int i,j;
+
+  if (tab[1] == 0) {
+    for (i=0; i<256; i++) {
+      for (crc=(uint32_t)i,j=0; j<8; j++)
+        crc = (crc & 1) ? (crc >> 1) ^ 0xedb88320 : crc >> 1;
+      tab[i] = crc;
+    }
+  }
+  for (crc=0xffffffff; len; len--)
+    crc = tab[(crc ^ *p++) & 0xff] ^ (crc >> 8);
+  return crc ^ 0xffffffff;
+}
+
+
+static bool debug_section(const char *name)
+{
+  return !strncmp(name,".debug",6) || !strncmp(name,".zdebug",7) ||
+         !strncmp(name,".line",5) || !strncmp(name,".stab",5);
+}
+
+
+void elf_splitdebug(struct GlobalVars *gv,FILE *f,uint8_t *img,
+                    unsigned long len)
+/* Write the ELF image, which was already written completely into the
+   debug file, without debugging sections and symbol table. Allocated
+   sections and program headers keep their file offsets. A .gnu_debuglink
+   section is appended, which refers to the debug file. */
+{
+  static const char *fn = "elf_splitdebug(): ";
+  static const char dlname[] = ".gnu_debuglink";
+  bool be = img[EI_DATA] == ELFDATA2MSB;
+  bool is64 = img[EI_CLASS] == ELFCLASS64;
+  const char *dbgname = base_name(gv->debug_name);
+  size_t ehsize = is64 ? sizeof(struct Elf64_Ehdr) : sizeof(struct Elf32_Ehdr);
+  size_t shsize = is64 ? sizeof(struct Elf64_Shdr) : sizeof(struct Elf32_Shdr);
+  uint64_t orgshoff,shoff,phoff,end,offs,dloffs,dlsize,strsize;
+  unsigned shnum,shstrndx,phnum,phentsize,i,n;
+  uint32_t crc;
+  struct SplitShdr *sh;
+  uint8_t *p,buf[sizeof(struct Elf64_Shdr)];
+  char *shstr,*newstr;
+  bool changed;
+
+  if (len<ehsize || memcmp(img,"\177ELF",4))
+    ierror("%sno ELF image",fn);
+  shoff = read_addr(be,is64,ELFFLD(Ehdr,img,e_shoff));
+  phoff = read_addr(be,is64,ELFFLD(Ehdr,img,e_phoff));
+  shnum = read16(be,ELFFLD(Ehdr,img,e_shnum));
+  shstrndx = read16(be,ELFFLD(Ehdr,img,e_shstrndx));
+  phnum = read16(be,ELFFLD(Ehdr,img,e_phnum));
+  phentsize = read16(be,ELFFLD(Ehdr,img,e_phentsize));
+  orgshoff = shoff;
+  if (shoff+shnum*shsize>len || phoff+phnum*phentsize>len ||
+      shstrndx==0 || shstrndx>=shnum)
+    ierror("%scorrupted ELF image",fn);
+
+  /* read section headers */
+  sh = alloczero(shnum * sizeof(struct SplitShdr));
+  for (i=0,p=img+shoff; i<shnum; i++,p+=shsize) {
+    sh[i].name = read32(be,ELFFLD(Shdr,p,sh_name));
+    sh[i].type = read32(be,ELFFLD(Shdr,p,sh_type));
+    sh[i].link = read32(be,ELFFLD(Shdr,p,sh_link));
+    sh[i].info = read32(be,ELFFLD(Shdr,p,sh_info));
+    sh[i].flags = read_addr(be,is64,ELFFLD(Shdr,p,sh_flags));
+    sh[i].offset = read_addr(be,is64,ELFFLD(Shdr,p,sh_offset));
+    sh[i].size = read_addr(be,is64,ELFFLD(Shdr,p,sh_size));
+    sh[i].align = read_addr(be,is64,ELFFLD(Shdr,p,sh_addralign));
+    sh[i].newidx = 1;  /* keep */
+  }
+  shstr = (char *)img + sh[shstrndx].offset;
+
+  /* mark unallocated debugging sections and the symbol table for removal */
+  for (i=1; i<shnum; i++) {
+    if (!(sh[i].flags & SHF_ALLOC) && i!=shstrndx &&
+        (sh[i].type==SHT_SYMTAB || debug_section(shstr+sh[i].name))) {
+      sh[i].newidx = 0;
+      if (sh[i].type==SHT_SYMTAB && sh[i].link<shnum &&
+          sh[i].link!=shstrndx && !(sh[sh[i].link].flags & SHF_ALLOC))
+        sh[sh[i].link].newidx = 0;  /* .strtab */
+    }
+  }
+  do {
+    /* remove relocations for removed sections, keep referenced sections */
+    changed = FALSE;
+    for (i=1; i<shnum; i++) {
+      if (sh[i].newidx) {
+        if ((sh[i].type==SHT_REL || sh[i].type==SHT_RELA) &&
+            sh[i].info<shnum && sh[sh[i].info].newidx==0) {
+          sh[i].newidx = 0;
+          changed = TRUE;
+        }
+        else if (sh[i].link<shnum && sh[sh[i].link].newidx==0) {
+          sh[sh[i].link].newidx = 1;
+          changed = TRUE;
+        }
+      }
+    }
+  } while (changed);
+
+  /* allocated contents and program headers remain unchanged */
+  end = ehsize;
+  if (phnum) {
+    if (phoff+phnum*phentsize > end)
+      end = phoff + phnum*phentsize;
+    for (i=0,p=img+phoff; i<phnum; i++,p+=phentsize) {
+      offs = read_addr(be,is64,ELFFLD(Phdr,p,p_offset)) +
+             read_addr(be,is64,ELFFLD(Phdr,p,p_filesz));
+      if (offs > end)
+        end = offs;
+    }
+  }
+  for (i=1,n=1,strsize=1; i<shnum; i++) {
+    if (sh[i].newidx) {
+      sh[i].newidx = n++;
+      sh[i].newname = strsize;
+      strsize += strlen(shstr+sh[i].name) + 1;
+      sh[i].newoffset = sh[i].offset;
+      if ((sh[i].flags & SHF_ALLOC) && sh[i].type!=SHT_NOBITS &&
+          sh[i].offset+sh[i].size > end)
+        end = sh[i].offset + sh[i].size;
+    }
+  }
+  if (end > len)
+    ierror("%scorrupted ELF image",fn);
+
+  /* build new .shstrtab */
+  newstr = alloc(strsize + sizeof(dlname));
+  *newstr = '\0';
+  for (i=1; i<shnum; i++) {
+    if (sh[i].newidx)
+      strcpy(newstr+sh[i].newname,shstr+sh[i].name);
+  }
+  strcpy(newstr+strsize,dlname);
+
+  /* unallocated sections, new .shstrtab and .gnu_debuglink follow */
+  for (i=1,offs=end; i<shnum; i++) {
+    if (sh[i].newidx && !(sh[i].flags & SHF_ALLOC) && i!=shstrndx &&
+        sh[i].type!=SHT_NOBITS) {
+      if (sh[i].align > 1)
+        offs = (offs + sh[i].align - 1) & ~(sh[i].align - 1);
+      sh[i].newoffset = offs;
+      offs += sh[i].size;
+    }
+  }
+  sh[shstrndx].newoffset = offs;
+  sh[shstrndx].size = strsize + sizeof(dlname);
+  dloffs = (offs + sh[shstrndx].size + 3) & ~3;
+  dlsize = ((strlen(dbgname) + 4) & ~3) + 4;
+  shoff = (dloffs + dlsize + 7) & ~7;
+
+  /* write file header, segments and allocated sections */
+  crc = debuglink_crc(img,len);  /* of the unmodified image */
+  write_addr(be,is64,ELFFLD(Ehdr,img,e_shoff),shoff);
+  write16(be,ELFFLD(Ehdr,img,e_shnum),n+1);
+  write16(be,ELFFLD(Ehdr,img,e_shstrndx),sh[shstrndx].newidx);
+  fwritex(f,img,end);
+
+  for (i=1,offs=end; i<shnum; i++) {
+    if (sh[i].newidx && !(sh[i].flags & SHF_ALLOC) && i!=shstrndx &&
+        sh[i].type!=SHT_NOBITS) {
+      fwritegap(gv,f,sh[i].newoffset-offs);
+      fwritex(f,img+sh[i].offset,sh[i].size);
+      offs = sh[i].newoffset + sh[i].size;
+    }
+  }
+  fwritegap(gv,f,sh[shstrndx].newoffset-offs);
+  fwritex(f,newstr,sh[shstrndx].size);
+  offs = sh[shstrndx].newoffset + sh[shstrndx].size;
+
+  /* .gnu_debuglink: file name, aligned to 4, and CRC of the debug file */
+  fwritegap(gv,f,dloffs-offs);
+  memset(buf,0,sizeof(buf));
+  fwritex(f,dbgname,strlen(dbgname));
+  fwritex(f,buf,dlsize-4-strlen(dbgname));
+  write32(be,buf,crc);
+  fwritex(f,buf,4);
+  fwritegap(gv,f,shoff-(dloffs+dlsize));
+
+  /* section header table */
+  memset(buf,0,shsize);
+  fwritex(f,buf,shsize);
+  for (i=1,p=img+orgshoff+shsize; i<shnum; i++,p+=shsize) {
+    if (sh[i].newidx) {
+      memcpy(buf,p,shsize);
+      write32(be,ELFFLD(Shdr,buf,sh_name),sh[i].newname);
+      write_addr(be,is64,ELFFLD(Shdr,buf,sh_offset),sh[i].newoffset);
+      if (i == shstrndx)
+        write_addr(be,is64,ELFFLD(Shdr,buf,sh_size),sh[i].size);
+      if (sh[i].link)
+        write32(be,ELFFLD(Shdr,buf,sh_link),sh[sh[i].link].newidx);
+      if (sh[i].info && sh[i].info<shnum &&
+          (sh[i].type==SHT_REL || sh[i].type==SHT_RELA ||
+           (sh[i].flags & SHF_INFO_LINK)))
+        write32(be,ELFFLD(Shdr,buf,sh_info),sh[sh[i].info].newidx);
+      fwritex(f,buf,shsize);
+    }
+  }
+  memset(buf,0,shsize);
+  write32(be,ELFFLD(Shdr,buf,sh_name),strsize);
+  write32(be,ELFFLD(Shdr,buf,sh_type),SHT_PROGBITS);
+  write_addr(be,is64,ELFFLD(Shdr,buf,sh_offset),dloffs);
+  write_addr(be,is64,ELFFLD(Shdr,buf,sh_size),dlsize);
+  write_addr(be,is64,ELFFLD(Shdr,buf,sh_addralign),4);
+  fwritex(f,buf,shsize);
+
+  free(newstr);
+  free(sh);
+}
+
+
 #endif  /* ELF32 || ELF64 */
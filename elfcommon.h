@@ -124,7 +124,8 @@
 #define SHT_PREINIT_ARRAY 16          /* Array of pre-constructors */
 #define SHT_GROUP         17          /* Section group */
 #define SHT_SYMTAB_SHNDX  18          /* Extended section indices */ 
-#define SHT_NUM           19          /* Number of defined types.  */
+#define SHT_RELR          19          /* Relative relocation bitmaps */
+#define SHT_NUM           20          /* Number of defined types.  */
 #define SHT_LOOS          0x60000000  /* Start OS-specific */   
 #define SHT_GNU_LIBLIST   0x6ffffff7  /* Prelink library list */
 #define SHT_CHECKSUM      0x6ffffff8  /* Checksum for DSO content.  */
@@ -227,9 +228,14 @@
 #define DT_ENCODING     32          /* Start of encoded range */
 #define DT_PREINIT_ARRAY 32         /* Array with addresses of preinit fct */
 #define DT_PREINIT_ARRAYSZ 33       /* size in bytes of DT_PREINIT_ARRAY */
-#define DT_NUM          34          /* Number used */
+#define DT_RELRSZ       35          /* Size in bytes of DT_RELR */
+#define DT_RELR         36          /* Address of relative reloc. bitmaps */
+#define DT_RELRENT      37          /* Size of a DT_RELR entry */
+#define DT_NUM          38          /* Number used */
 #define DT_LOOS         0x6000000d  /* Start of OS-specific */
 #define DT_HIOS         0x6ffff000  /* End of OS-specific */
+#define DT_RELACOUNT    0x6ffffff9  /* Number of leading relative RELA */
+#define DT_RELCOUNT     0x6ffffffa  /* Number of leading relative REL */
 #define DT_LOPROC       0x70000000
 #define DT_HIPROC       0x7fffffff
 
@@ -247,7 +253,8 @@ struct Elf_CommonHdr {
 #define STRHTABSIZE    0x10000
 #define SHSTRHTABSIZE  0x100
 #define DYNSTRHTABSIZE 0x1000
-#define DYNSYMHTABSIZE 0x1000
+#define SYMTABINITSIZE 0x400  /* initial symbols, doubled when needed */
+#define DYNSYMTABINITSIZE 0x100
 #define STABHTABSIZE   0x1000
 
 struct StrTabNode {
@@ -265,19 +272,18 @@ struct StrTabList {
 };
 
 struct SymbolNode {
-  struct node n;
   struct SymbolNode *hashchain;
-  void *elfsym;
   const char *name;
   uint32_t index;
   uint16_t shndx;
 };
 
 struct SymTabList {
-  struct list l;
+  struct SymbolNode *nodes;     /* array of nodes, in symbol table order */
+  uint8_t *elfsyms;             /* ELF symbols, in symbol table order */
   struct StrTabList *strlist;
-  struct SymbolNode **hashtab;
-  size_t htabsize;
+  struct SymbolNode **hashtab;  /* newest node first in a chain */
+  size_t htabsize;              /* power of 2, number of allocated nodes */
   size_t elfsymsize;
   uint32_t nextindex;
   uint32_t globalindex;
@@ -303,6 +309,12 @@ struct RelocNode {
   void *elfreloc;
 };
 
+struct DynRelocRef {            /* dynamic relocation, sorted for output */
+  struct LinkedSection *ls;     /* section containing the relocation */
+  struct Reloc *rel;
+  uint32_t symidx;              /* .dynsym index, 0 for relative relocs */
+};
+
 /* for conversion from ELF reloc types to vlink internal format */
 struct ELF2vlink {
   uint8_t rtype;
@@ -334,6 +346,8 @@ extern struct list shdrlist;
 extern struct list elfdynsymlist;
 extern struct Section *elfdynrelocs;       
 extern struct Section *elfpltrelocs; 
+extern struct Section *elfrelrrelocs;
+extern unsigned long elfrelcount;
 extern int8_t elf_endianness;
 extern uint32_t elfshdridx,elfsymtabidx,elfshstrtabidx,elfstrtabidx;
 extern uint32_t elfoffset;
@@ -345,6 +359,7 @@ extern const char dynsym_name[];
 extern const char dynstr_name[];
 extern const char *dynrel_name[2];
 extern const char *pltrel_name[2];
+extern const char relr_name[];
 #endif
 
 
@@ -380,6 +395,7 @@ struct Symbol *elf_pltgotentry(struct GlobalVars *,struct Section *,DynArg,
                                bool,size_t,size_t);
 struct Symbol *elf_bssentry(struct GlobalVars *,const char *,struct Symbol *,
                             bool,size_t,size_t);
+void elf_relrsize(struct GlobalVars *);
 size_t elf_num_buckets(size_t);
 void elf_putsymtab(uint8_t *,struct SymTabList *);
 
@@ -421,5 +437,8 @@ void elf_writesections(struct GlobalVars *,FILE *f);
 void elf_writestrtab(FILE *,struct StrTabList *);
 void elf_writesymtab(FILE *,struct SymTabList *);
 void elf_writerelocs(FILE *,struct RelocList *);
+struct DynRelocRef *elf_dynrelocs(struct GlobalVars *,unsigned long *);
+void elf_putrelr(struct GlobalVars *);
+void elf_splitdebug(struct GlobalVars *,FILE *,uint8_t *,unsigned long);
 
 #endif
@@ -212,6 +212,17 @@ static struct {
     "with name \"%s\" in unit \"%s\". Trying to ignore",EF_WARNING,
   "%s: Duplicate con/destructor name %s definition ignored",EF_WARNING,
   "Warnings treated as errors",EF_ERROR,
+  "Far-call stubs of section %s overlap with section %s",EF_ERROR,
+  "Reading link output from cache directory %s failed",EF_FATAL,
+  "Option -debugfile is not supported for %s",EF_FATAL,             /* 155 */
+  "%s (%s+%#lx): Reference to %s in overlay node %d, which is not "
+    "loaded together with the referencing node",EF_ERROR,
+  "Illegal overlay level: %s",EF_FATAL,
+  "Maximum number of %d overlay nodes exceeded",EF_FATAL,
+  "%s: Overlay nodes are ignored",EF_WARNING,
+  "%s (%s+%#lx): Branch is out of range of its far-call stub",EF_ERROR,/* 160 */
+  "Debug file %s must differ from the output file",EF_FATAL,
+  "Option -sdrefs is ignored without a map file (-M)",EF_WARNING,
 };
 
 
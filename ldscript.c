@@ -33,9 +33,12 @@ static lword dataval;
 static char *secblkbase;
 static int secblkline;
 
-/* for 2nd pass over a section definition block: */
-static char *secdefbase;
-static int secdefline;
+/* compiled section definition block, for phase 1 and 2 in linker_join */
+static struct SecDefItem *sditems;
+static struct SecDefItem *sdnext;
+static bool sdcompiled;
+static char *secdefend;
+static int secdefendline;
 
 /* Default segment names (including a blank to prevent redefinitions) */
 static const char *defhdr = " headers";
@@ -249,7 +252,9 @@ static struct Phdr *add_phdr(struct GlobalVars *gv,const char *name,
   new->lmregion = lmreg;
 
   if (type == PT_LOAD) {
-    if (!gv->no_page_align)
+    if (gv->huge_pages)
+      new->alignment = HUGEPAGE_ALIGN;
+    else if (!gv->no_page_align)
       new->alignment = shiftcnt(fff[gv->dest_format]->page_size);
   }
   else if (type == PT_PHDR)
@@ -1684,7 +1689,7 @@ static void add_section_to_segments(struct GlobalVars *gv,
 
 
 void free_patterns(char *fpat,char **spatlist)
-/* free file-pattern and section-pattern list, allocated in next_pattern() */
+/* free file-pattern and section-pattern list, allocated in parse_pattern() */
 {
   char **p;
 
@@ -1875,28 +1880,34 @@ static struct Section *reserve_space(struct GlobalVars *gv)
 }
 
 
-int test_pattern(struct GlobalVars *gv,char **fpat,char ***spatlist)
-/* Provides next file/section-patterns, but doesn't execute any commands
-   or assignments. It will remember the initial parsing state to
-   do it a second time for real with next_pattern().
-   Return Codes: 0=no more patterns, -1=pattern, >0=alignment */
+static void compile_secdef(struct GlobalVars *gv)
+/* Parse the contents of a section definition block once and translate
+   it into a list of SecDefItems. File/section patterns are kept in their
+   parsed form, while commands and assignments remember their position
+   in the script, to be executed in the second phase. */
 {
-  char c,*keyword;
+  struct SecDefItem *item,**tail = &sditems;
+  char c,*keyword,*txt;
+  int line;
 
-  if (!secdefbase) {
-    secdefbase = gettxtptr();
-    secdefline = getlineno();
-  }
-  *fpat = NULL;
-  *spatlist = NULL;
   level = 2;
 
   do {
-    while (keyword = getpattern()) {
+    for (;;) {
+      txt = gettxtptr();
+      line = getlineno();
+      if (!(keyword = getpattern()))
+        break;
+      item = alloczero(sizeof(struct SecDefItem));
+      item->type = SDI_STMT;
+      item->txt = txt;
+      item->line = line;
+
       if (check_command(gv,keyword,SCMDF_IGNORE|SCMDF_SECDEF)) {
-        if (datasize)
-          return dataalign;
-        continue;
+        if (datasize) {
+          item->type = SDI_DATA;
+          item->align = dataalign;
+        }
       }
       else {
         c = getchr();
@@ -1904,21 +1915,78 @@ int test_pattern(struct GlobalVars *gv,char **fpat,char ***spatlist)
           skip_expr(0);
         }
         else if (c == '(') {
-          if (parse_pattern(gv,keyword,fpat,spatlist))
-            return -1;
+          if (!parse_pattern(gv,keyword,&item->fpat,&item->spatlist)) {
+            free(item);
+            continue;
+          }
+          item->type = SDI_PATTERN;
+          item->scriptflags = gv->scriptflags;
         }
         else {
           /* unknown keyword ignored */
           error(65,scriptname,getlineno(),keyword);
           back(1);
+          free(item);
+          continue;
         }
       }
+      *tail = item;
+      tail = &item->next;
     }
   }
   while (getchr() == ';');
   back(1);
 
+  *tail = NULL;
+  secdefend = gettxtptr();
+  secdefendline = getlineno();
+  sdnext = sditems;
+  sdcompiled = TRUE;
   level = 1;
+}
+
+
+static void free_secdef(void)
+{
+  struct SecDefItem *item;
+
+  while (item = sditems) {
+    sditems = item->next;
+    if (item->type == SDI_PATTERN)
+      free_patterns(item->fpat,item->spatlist);
+    free(item);
+  }
+  sdnext = NULL;
+  sdcompiled = FALSE;
+}
+
+
+int test_pattern(struct GlobalVars *gv,char **fpat,char ***spatlist)
+/* Provides next file/section-patterns, but doesn't execute any commands
+   or assignments. The section definition is compiled on the first call,
+   then next_pattern() will walk it a second time for real.
+   The patterns remain valid until the section definition is closed.
+   Return Codes: 0=no more patterns, -1=pattern, >0=alignment */
+{
+  struct SecDefItem *item;
+
+  if (!sdcompiled)
+    compile_secdef(gv);
+  *fpat = NULL;
+  *spatlist = NULL;
+
+  while (item = sdnext) {
+    sdnext = item->next;
+    if (item->type == SDI_PATTERN) {
+      *fpat = item->fpat;
+      *spatlist = item->spatlist;
+      return -1;
+    }
+    else if (item->type==SDI_DATA && item->align>0)
+      return item->align;
+  }
+
+  sdnext = sditems;  /* rewind for next_pattern() */
   return 0;
 }
 
@@ -1932,42 +2000,40 @@ struct Section *next_pattern(struct GlobalVars *gv,char **fpat,char ***spatlist)
   static char *fn = "next_pattern(): ";
   static struct Phdr **defplist;
   struct Phdr **plist;
-  char c,*keyword;
+  struct SecDefItem *item;
+  char *keyword;
 
+  if (!sdcompiled)
+    compile_secdef(gv);
   level = 2;
   *fpat = NULL;
   *spatlist = NULL;
-  if (secdefbase) {
-    /* reset to beginning of section definition */
-    init_parser(gv,scriptname,secdefbase,secdefline);
-    secdefbase = NULL;
-  }
 
-  do {
-    while (keyword = getpattern()) {
+  while (item = sdnext) {
+    sdnext = item->next;
+    if (item->type == SDI_PATTERN) {
+      gv->scriptflags = item->scriptflags;
+      *fpat = item->fpat;
+      *spatlist = item->spatlist;
+      return VALIDPAT;
+    }
+
+    /* execute command or assignment at its position in the script */
+    init_parser(gv,scriptname,item->txt,item->line);
+    if (keyword = getpattern()) {
       if (check_command(gv,keyword,SCMDF_GLOBAL|SCMDF_SECDEF)) {
         if (datasize < 0)
           return reserve_space(gv);
         else if (datasize)
           return make_data_element(gv);
-        continue;
-      }
-      else {
-        c = getchr();
-        if (c == '=') {
-          symbol_assignment(gv,keyword,0);
-        }
-        else if (c == '(') {
-          if (parse_pattern(gv,keyword,fpat,spatlist))
-            return VALIDPAT;
-        }
-        else
-          back(1);
       }
+      else if (getchr() == '=')
+        symbol_assignment(gv,keyword,0);
     }
   }
-  while (getchr() == ';');
-  back(1);
+
+  /* continue behind the section definition's contents */
+  init_parser(gv,scriptname,secdefend,secdefendline);
 
   level = 1;
   if (plist = endofsecdef(gv,NULL)) {
@@ -2048,6 +2114,7 @@ struct Section *next_pattern(struct GlobalVars *gv,char **fpat,char ***spatlist)
   vdefmem = current_ls->relocmem;
   ldefmem = current_ls->destmem;
   current_ls = NULL;
+  free_secdef();
   return NULL;
 }
 
@@ -2090,7 +2157,7 @@ struct LinkedSection *next_secdef(struct GlobalVars *gv)
               change_address(ls->destmem,s_lma);
             }
 
-            secdefbase = NULL;
+            free_secdef();
             return ls;
           }
         }
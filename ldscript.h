@@ -18,6 +18,22 @@ struct ScriptCmd {
   void (*cmdptr)(struct GlobalVars *);
 };
 
+/* compiled element of a section definition block */
+struct SecDefItem {
+  struct SecDefItem *next;
+  int type;                 /* SDI_PATTERN, SDI_DATA or SDI_STMT */
+  char *fpat;               /* file pattern */
+  char **spatlist;          /* list of section patterns */
+  uint8_t scriptflags;      /* LDSF_KEEP, LDSF_SORTFIL, LDSF_SORTSEC */
+  int align;                /* alignment required by a data command */
+  char *txt;                /* statement's position in the script */
+  int line;
+};
+
+#define SDI_PATTERN 0       /* file/section patterns */
+#define SDI_DATA 1          /* data command (BYTE, SHORT, etc.) */
+#define SDI_STMT 2          /* other commands and assignments */
+
 #define SCMDF_SECDEF 1      /* valid in section definitions only */
 #define SCMDF_GLOBAL 2      /* valid everywhere */
 #define SCMDF_PAREN 0x2000  /* has arguments in parentheses */
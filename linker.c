@@ -8,6 +8,8 @@
 
 #define LINKER_C
 #include "vlink.h"
+#include "aout.h"
+#include "amigahunks.h"
 
 
 static char namebuf[FNAMEBUFSIZE];
@@ -137,29 +139,112 @@ static struct Symbol *lnksymbol(struct GlobalVars *gv,struct Section *sec,
 }
 
 
+#if defined(AMIGAOS) || defined(_WIN32)
+#define FNAMECASE(c) tolower((unsigned char)(c))
+#define FNAMECMP(a,b) stricmp(a,b)
+#else
+#define FNAMECASE(c) (c)
+#define FNAMECMP(a,b) strcmp(a,b)
+#endif
+
+#define DIRHTABSIZE 0x100
+
+struct DirEntry {
+  struct DirEntry *next;        /* next entry with same hash code */
+  const char *name;
+};
+
+struct DirIndex {               /* cached contents of a search directory */
+  struct DirIndex *next;
+  const char *path;
+  bool valid;                   /* directory could be read */
+  struct DirEntry *htab[DIRHTABSIZE];
+};
+
+static struct DirIndex *dircache;
+
+
+static unsigned long fname_hash(const char *name)
+{
+  unsigned long h = 0;
+
+  while (*name)
+    h = h * 31 + FNAMECASE(*name++);
+  return h % DIRHTABSIZE;
+}
+
+
+static struct DirIndex *index_directory(char *dirname)
+/* Return the cached list of file names of a directory. When the
+   directory has not been read before, it is scanned now. */
+{
+  struct DirIndex *di;
+  struct DirEntry *de;
+  char *dd,*scan;
+  unsigned long h;
+
+  for (di=dircache; di; di=di->next) {
+    if (!strcmp(di->path,dirname))
+      return di;
+  }
+
+  di = alloczero(sizeof(struct DirIndex));
+  di->path = allocstring(dirname);
+#ifndef ATARI  /* Fsfirst() won't list a directory's contents */
+  if (dd = open_dir(dirname)) {
+    while (scan = read_dir(dd)) {
+      de = alloc(sizeof(struct DirEntry));
+      de->name = allocstring(scan);
+      h = fname_hash(scan);
+      de->next = di->htab[h];
+      di->htab[h] = de;
+    }
+    close_dir(dd);
+    di->valid = TRUE;
+  }
+#endif
+  di->next = dircache;
+  dircache = di;
+  return di;
+}
+
+
 static char *scan_directory(char *dirname,char *libname,int so_ver)
 {
   size_t lnlen=strlen(libname);
-  char *dd,*scan,*fname=NULL;
+  struct DirIndex *di = index_directory(dirname);
+  struct DirEntry *de;
+  const char *scan;
+  char *fname=NULL;
   char maxname[FNAMEBUFSIZE];
   int maxver=0,maxsubver=-1;
+  unsigned long h;
 
   if (so_ver < 0) {
-    /* no need to scan the directory */
+    /* no need to scan the directory, just look for the name */
+    if (di->valid) {
+      for (de=di->htab[fname_hash(libname)]; de; de=de->next) {
+        if (!FNAMECMP(de->name,libname))
+          break;
+      }
+      if (de == NULL)
+        return NULL;
+    }
     fname = libname;
   }
   else {
-    if (dd = open_dir(dirname)) {
-      while (scan = read_dir(dd)) {
+    for (h=0; h<DIRHTABSIZE && fname!=libname; h++) {
+      for (de=di->htab[h]; de; de=de->next) {
+        scan = de->name;
         if (!strncmp(scan,libname,lnlen)) {
           /* found a library archive/shared object name! */
           if (!strcmp(scan,libname) && so_ver==0) {  /* perfect match */
-            fname = scan;
+            fname = libname;
             break;
           }
           else {  /* find highest version */
             if (scan[lnlen]=='.' && scan[lnlen+1]) {
-              char *p = &scan[lnlen+1];
+              const char *p = &scan[lnlen+1];
               int ver = atoi(p++);
               int subver = 0;
 
@@ -181,7 +266,6 @@ static char *scan_directory(char *dirname,char *libname,int so_ver)
           }
         }
       }
-      close_dir(dd);
     }
   }
 
@@ -259,53 +343,57 @@ static char *maplibrary(struct GlobalVars *gv,struct InputFile *ifn)
 }
 
 
-static void addrelref(struct RelRef **rrptr,struct Section *sec)
-/* if not already exists, add a new relative reference to another sect. */
+static struct Section *relgroup_root(struct Section *sec)
+/* Return the representative of a group of sections, which are connected
+   by relative references (union-find with path compression). */
 {
-  struct RelRef *rr;
+  struct Section *root,*next;
 
-  if (rr = *rrptr) {
-    while (rr->next) {
-      if (rr->refsec == sec)
-        return;  /* reference already exists */
-      rr = rr->next;
-    }
+  for (root=sec; root->relgroup!=root; root=root->relgroup);
+  while (sec != root) {
+    next = sec->relgroup;
+    sec->relgroup = root;
+    sec = next;
   }
-  else
-    rr = (struct RelRef *)rrptr;
-
-  rr->next = alloczero(sizeof(struct RelRef));
-  rr->next->refsec = sec;
+  return root;
 }
 
 
-static bool checkrr(struct RelRef *rr,struct Section *sec)
-/* Check if there is a relative reference to the specified section. */
+static void addrelref(struct Section *sec1,struct Section *sec2)
+/* put two sections, connected by a relative reference, into one group */
 {
-  while (rr) {
-    if (rr->refsec == sec)
-      return (TRUE);
-    rr = rr->next;
-  }
-  return (FALSE);
+  if (sec1->relgroup == NULL)
+    sec1->relgroup = sec1;
+  if (sec2->relgroup == NULL)
+    sec2->relgroup = sec2;
+  sec1 = relgroup_root(sec1);
+  sec2 = relgroup_root(sec2);
+  if (sec1 != sec2)
+    sec2->relgroup = sec1;
 }
 
 
 static bool checkrelrefs(struct LinkedSection *ls,struct Section *newsec)
-/* Check if there is a relative reference between those sections */
+/* Check if there is a relative reference between those sections,
+   either directly or by way of other sections */
 {
-  struct Section *sec;
+  if (newsec->relgroup == NULL)
+    return FALSE;  /* no relative references at all */
+  return relgroup_root(newsec)->grouplnk == ls;
+}
 
-  for (sec=(struct Section *)ls->sections.first;
-       sec->n.next!=NULL; sec=(struct Section *)sec->n.next) {
-    /* check for references to 'newsec' */
-    if (checkrr(sec->relrefs,newsec))
-      return (TRUE);
-    /* check for references from 'newsec' */
-    if (checkrr(newsec->relrefs,sec))
-      return (TRUE);
+
+static void relgroup_join(struct LinkedSection *ls,struct Section *sec)
+/* Remember the LinkedSection which received the first member of a
+   group of sections with relative references. */
+{
+  struct Section *root;
+
+  if (sec->relgroup != NULL) {
+    root = relgroup_root(sec);
+    if (root->grouplnk == NULL)
+      root->grouplnk = ls;
   }
-  return (FALSE);
 }
 
 
@@ -397,17 +485,23 @@ static void merge_sec_attrs(struct LinkedSection *lsn,struct Section *sec,
 
 static struct LinkedSection *get_matching_lnksec(struct GlobalVars *gv,
                                                  struct Section *sec,
-                                                 struct LinkedSection *myls)
+                                                 struct LinkedSection *myls,
+                                                 struct LinkedSection *only,
+                                                 unsigned long since)
 /* find a LinkedSection node which matches the attributes of the
-   specified section, but which is different from 'myls' */
+   specified section, but which is different from 'myls'. Only
+   LinkedSections modified after the join stamp 'since' are checked,
+   or just 'only', when not NULL. */
 {
-  struct LinkedSection *lsn = (struct LinkedSection *)gv->lnksec.first;
+  struct LinkedSection *lsn = only ? only :
+                              (struct LinkedSection *)gv->lnksec.first;
   struct LinkedSection *nextlsn;
   uint8_t f;
   int tl;
 
   while (nextlsn = (struct LinkedSection *)lsn->n.next) {
-    if (lsn != myls && ((f = cmpsecflags(gv,lsn,sec)) != 0xff)) {
+    if (lsn != myls && lsn->joinstamp >= since &&
+        ((f = cmpsecflags(gv,lsn,sec)) != 0xff)) {
       f &= ~SF_PORTABLE_MASK;
 
       if (!gv->dest_object) {
@@ -506,6 +600,8 @@ static struct LinkedSection *get_matching_lnksec(struct GlobalVars *gv,
 
       } /* default rules */
     }
+    if (only)
+      break;
     lsn = nextlsn;
   }
   return (NULL);
@@ -528,6 +624,10 @@ static struct Section *last_initialized(struct LinkedSection *ls)
 }
 
 
+static struct Symbol **commons;  /* allocated common symbols for map */
+static size_t ncommons,maxcommons;
+
+
 static unsigned long allocate_common(struct GlobalVars *gv,
                                      struct Section *sec,unsigned long addr)
 /* allocate all common symbols to section 'sec' at 'addr',
@@ -548,10 +648,14 @@ static unsigned long allocate_common(struct GlobalVars *gv,
         sym->type = SYM_RELOC;
         alloc += abytes + sym->size;
 
-        if (gv->map_file)
-          fprintf(gv->map_file,"Allocating common %s: %x at %llx hex\n",
-                  sym->name,(int)sym->size,
-                  (unsigned long long)sec->va+sym->value);
+        if (gv->map_file) {
+          /* print it with print_commons(), when the address is final */
+          if (ncommons >= maxcommons) {
+            maxcommons = maxcommons ? maxcommons<<1 : 64;
+            commons = re_alloc(commons,maxcommons*sizeof(struct Symbol *));
+          }
+          commons[ncommons++] = sym;
+        }
       }
     }
   }
@@ -561,6 +665,19 @@ static unsigned long allocate_common(struct GlobalVars *gv,
 }
 
 
+static void print_commons(struct GlobalVars *gv)
+/* print the allocated common symbols to the map file */
+{
+  size_t i;
+
+  for (i=0; i<ncommons; i++)
+    fprintf(gv->map_file,"Allocating common %s: %x at %llx hex\n",
+            commons[i]->name,(int)commons[i]->size,
+            (unsigned long long)commons[i]->relsect->va+commons[i]->value);
+  ncommons = 0;
+}
+
+
 void print_symbol(struct GlobalVars *gv,FILE *f,struct Symbol *sym)
 /* print symbol name, type, value, etc. */
 {
@@ -732,6 +849,17 @@ static void dyn_reloc_entry(struct GlobalVars *gv,struct Reloc *reloc,
 }
 
 
+static bool gotrelax(struct GlobalVars *gv,struct Section *sec,
+                     struct Reloc *r)
+/* Let the target turn a relaxable GOT reference to a locally defined
+   symbol into a direct pc-relative reference. Returns TRUE on success. */
+{
+  if (fff[gv->dest_format]->gotrelax)
+    return fff[gv->dest_format]->gotrelax(gv,sec,r);
+  return FALSE;
+}
+
+
 static void dyn_so_needed(struct GlobalVars *gv,struct ObjectUnit *ou)
 {
   DynArg a;
@@ -878,6 +1006,7 @@ static void merge_ld_section(struct GlobalVars *gv,uint8_t stype,
       (!gv->dest_object || gv->alloc_common) && stype==ST_UDATA) {
     update_address(ls->relocmem,ls->destmem,
                    allocate_common(gv,sec,ls->relocmem->current));
+    print_commons(gv);
   }
 
   addtail(&ls->sections,remnode(&sec->n));
@@ -893,17 +1022,46 @@ static void merge_ld_section(struct GlobalVars *gv,uint8_t stype,
 
 
 static void merge_seclist(struct GlobalVars *gv,struct list *seclist)
+/* Each pass merges all sections into matching LinkedSections and creates
+   a new LinkedSection for the first section without a match. A section
+   is only checked again against LinkedSections which have been modified
+   since its last check, as the result depends on nothing else. */
 {
+  static unsigned long joinclock;
+  static struct LinkedSection *lastls;  /* modified at joinclock */
   struct LinkedSection *ls;
-  struct Section *sec,*nextsec;
+  struct Section *sec;
+  struct SecStamp {
+    struct Section *sec;
+    unsigned long since;        /* check LinkedSections from this stamp */
+  } *sarray;
+  int i,n,left;
+
+  for (n=0,sec=(struct Section *)seclist->first;
+       sec->n.next!=NULL; sec=(struct Section *)sec->n.next)
+    n++;
+  if (n == 0)
+    return;
+  sarray = alloc(n * sizeof(struct SecStamp));
+  for (i=0,sec=(struct Section *)seclist->first;
+       sec->n.next!=NULL; sec=(struct Section *)sec->n.next,i++) {
+    sarray[i].sec = sec;
+    sarray[i].since = 0;  /* check all */
+  }
 
-  do {
+  for (left=n; left>0; ) {
     bool create_allowed = TRUE;
 
-    sec = (struct Section *)seclist->first;
-
-    while (nextsec = (struct Section *)sec->n.next) {
-      ls = get_matching_lnksec(gv,sec,NULL);
+    for (i=0; i<n; i++) {
+      if ((sec = sarray[i].sec) == NULL)
+        continue;  /* already merged */
+      if (sarray[i].since > joinclock)
+        ls = NULL;  /* nothing changed since the last check */
+      else if (sarray[i].since == joinclock)
+        ls = get_matching_lnksec(gv,sec,NULL,lastls,0);
+      else
+        ls = get_matching_lnksec(gv,sec,NULL,NULL,sarray[i].since);
+      sarray[i].since = joinclock + 1;
 
       if (!ls && create_allowed) {
         Dprintf("new: %s(%s) -> %s\n",getobjname(sec->obj),
@@ -912,23 +1070,41 @@ static void merge_seclist(struct GlobalVars *gv,struct list *seclist)
                             sec->protection,sec->alignment,sec->memattr);
         create_allowed = FALSE;
       }
-      if (ls)
+      if (ls) {
         addtail(&ls->sections,remnode(&sec->n));
-
-      sec = nextsec;
+        relgroup_join(ls,sec);
+        ls->joinstamp = ++joinclock;
+        lastls = ls;
+        sarray[i].sec = NULL;
+        left--;
+      }
     }
   }
-  while (!(listempty(seclist)));
+  free(sarray);
 }
 
 
-static int sym_addr_cmp(const void *left,const void *right)
-/* qsort: compare symbol addresses */
+static struct SortKey *sorted_symbols(struct LinkedSection *ls,
+                                      unsigned long *cnt)
+/* return the section's symbols in an array, sorted by address */
 {
-  unsigned long addrl = (*(struct Symbol **)left)->value;
-  unsigned long addrr = (*(struct Symbol **)right)->value;
-
-  return (addrl<addrr) ? -1 : ((addrl>addrr) ? 1 : 0);
+  struct SortKey *keys;
+  struct Symbol *sym;
+  unsigned long n;
+
+  for (n=0,sym=(struct Symbol *)ls->symbols.first;
+       sym->n.next!=NULL; sym=(struct Symbol *)sym->n.next)
+    n++;
+  if ((*cnt = n) == 0)
+    return NULL;
+  keys = alloc(n * sizeof(struct SortKey));
+  for (n=0,sym=(struct Symbol *)ls->symbols.first;
+       sym->n.next!=NULL; sym=(struct Symbol *)sym->n.next,n++) {
+    keys[n].key = (unsigned long)sym->value;
+    keys[n].ptr = sym;
+  }
+  radix_sort(keys,n);
+  return keys;
 }
 
 
@@ -954,12 +1130,59 @@ void linker_init(struct GlobalVars *gv)
   else
     gv->reloctab_format = fff[gv->dest_format]->rtab_format;
 
+  if (gv->debug_name) {
+    /* separate debug file is only written by a few executable formats */
+    if (fff[gv->dest_format]->splitdebug == NULL)
+      error(155,fff[gv->dest_format]->tname);
+    else if (gv->dest_object || gv->output_sections)
+      error(155,"relocatable output or section files");
+    else if (gv->keep_relocs)
+      error(155,"executables with relocations (-q)");
+    else if (!FNAMECMP(gv->debug_name,gv->dest_name))
+      error(161,gv->debug_name);  /* would truncate the mapped image */
+  }
+
+  if (gv->sd_report && gv->map_file==NULL)
+    error(162);
+
   /* init destination format */
   if (fff[gv->dest_format]->init != NULL)
     fff[gv->dest_format]->init(gv,FFINI_DESTFMT);
 }
 
 
+static uint32_t input_class(const char *name,uint8_t *p,unsigned long plen)
+/* Determine the class of an input file by its magic id, so only the
+   targets of this class have to be asked to identify it. Library
+   archives are classified by their first member. Returns 0 for an
+   unknown class, which means that all targets have to be tried. */
+{
+  struct ar_info ai;
+  uint32_t w;
+
+  if (ar_init(&ai,(char *)p,plen,name)) {
+    if (!ar_extract(&ai))
+      return 0;  /* let the targets report the empty archive */
+    p = (uint8_t *)ai.data;
+    plen = ai.size;
+  }
+
+  if (plen >= 4) {
+    if (!strncmp((char *)p,"\177ELF",4))
+      return FFF_ID_ELF;
+    if (!strncmp((char *)p,"VOBJ",4))
+      return FFF_ID_VOBJ;
+    w = read32be(p);
+    if (w==HUNK_UNIT || w==HUNK_LIB || w==HUNK_HEADER)
+      return FFF_ID_HUNK;
+    w &= 0xffff;
+    if (w==OMAGIC || w==NMAGIC || w==ZMAGIC || w==QMAGIC)
+      return FFF_ID_AOUT;
+  }
+  return 0;
+}
+
+
 void linker_load(struct GlobalVars *gv)
 /* load all objects and libraries into memory, identify their */
 /* format, then read all symbols and convert into internal format */
@@ -969,6 +1192,7 @@ void linker_load(struct GlobalVars *gv)
   uint8_t *objptr;
   const char *objname;
   unsigned long objlen;
+  uint32_t idclass;
   int i,ff;
 
   init_ld_script(gv);       /* pre-parse linker script, when available */
@@ -1008,8 +1232,13 @@ void linker_load(struct GlobalVars *gv)
     objlen = *(size_t *)(objptr - sizeof(size_t));
     objname = base_name(namebuf);
 
-    /* determine the object's file format */
+    /* determine the object's file format, skipping all targets
+       which belong to a different class of input files */
+    idclass = input_class(objname,objptr,objlen);
     for (i=0,ff=ID_UNKNOWN; fff[i]; i++) {
+      if (idclass && (fff[i]->flags & FFF_IDMASK) &&
+          (fff[i]->flags & FFF_IDMASK) != idclass)
+        continue;
       if ((ff = (fff[i]->identify)(gv,(char *)objname,objptr,objlen,ifn->lib))
           != ID_UNKNOWN)
         break;
@@ -1099,6 +1328,99 @@ static void libpullmsg(struct GlobalVars *gv,struct ObjectUnit *pull_unit,
 }
 
 
+/* Cache for resolving external references in linker_resolve(). Each
+   distinct name and mask is looked up only once, as long as there is
+   not more than a single definition (which makes the result independent
+   of the referring section) and no new definition was added since. */
+#define SYMCACHESIZE 0x4000
+
+struct SymCache {
+  struct SymCache *next;
+  const char *name;
+  uint32_t mask;
+  struct Symbol *sym;           /* result of findsymbol(), when SCF_VALID */
+  uint8_t flags;
+};
+#define SCF_VALID 1             /* sym is the only possible result */
+#define SCF_TRACE 2             /* trace accesses to this symbol */
+
+static struct SymCache **symcache;
+
+
+static struct SymCache *cached_findsymbol(struct GlobalVars *gv,
+                                          struct Section *sec,
+                                          const char *name,uint32_t mask,
+                                          struct Symbol **xdef)
+/* findsymbol() with memoisation of the result, which is returned in xdef */
+{
+  unsigned long h = elf_hash(name);
+  struct SymCache *sc;
+  struct Symbol *sym,*def;
+  int ndefs;
+
+  for (sc=symcache[h%SYMCACHESIZE]; sc; sc=sc->next) {
+    if (sc->mask==mask && (sc->name==name || !strcmp(sc->name,name)))
+      break;
+  }
+  if (sc == NULL) {
+    /* first reference to this name */
+    sc = alloc(sizeof(struct SymCache));
+    sc->next = symcache[h%SYMCACHESIZE];
+    sc->name = name;
+    sc->mask = mask;
+    sc->flags = trace_sym_access(gv,name) ? SCF_TRACE : 0;
+    symcache[h%SYMCACHESIZE] = sc;
+  }
+  else if (sc->flags & SCF_VALID) {
+    *xdef = sc->sym;
+    return sc;
+  }
+
+  /* count definitions with this name */
+  for (sym=gv->symbols[h%SYMHTABSIZE],def=NULL,ndefs=0; sym!=NULL;
+       sym=sym->glob_chain) {
+    if (!strcmp(name,sym->name)) {
+      def = sym;
+      ndefs++;
+    }
+  }
+  sc->sym = *xdef = findsymbol(gv,sec,name,mask);
+  if (ndefs==0 || (ndefs==1 && def->type!=SYM_INDIR))
+    sc->flags |= SCF_VALID;
+  return sc;
+}
+
+
+void symcache_invalidate(const char *name)
+/* a new global symbol with this name was defined */
+{
+  struct SymCache *sc;
+
+  if (symcache) {
+    for (sc=symcache[elf_hash(name)%SYMCACHESIZE]; sc; sc=sc->next) {
+      if (!strcmp(sc->name,name))
+        sc->flags &= ~SCF_VALID;
+    }
+  }
+}
+
+
+static void free_symcache(void)
+{
+  struct SymCache *sc,*next;
+  int i;
+
+  for (i=0; i<SYMCACHESIZE; i++) {
+    for (sc=symcache[i]; sc; sc=next) {
+      next = sc->next;
+      free(sc);
+    }
+  }
+  free(symcache);
+  symcache = NULL;
+}
+
+
 void linker_resolve(struct GlobalVars *gv)
 /* Resolve all symbol references and pull the required objects into */
 /* the gv->selobjects list. */
@@ -1119,11 +1441,13 @@ void linker_resolve(struct GlobalVars *gv)
 
   if (obj->n.next == NULL)
     return;  /* no objects in list */
+  symcache = alloc_hashtable(SYMCACHESIZE);
 
   do {
     struct Section *sec;
     struct Reloc *xref;
     struct Symbol *xdef;
+    struct SymCache *sc;
     struct ObjectUnit *pull_unit;
     uint32_t cmask;
 
@@ -1155,7 +1479,7 @@ void linker_resolve(struct GlobalVars *gv)
         }
 
         /* find a global symbol with this name in any object or library */
-        xdef = findsymbol(gv,sec,xref->xrefname,cmask);
+        sc = cached_findsymbol(gv,sec,xref->xrefname,cmask,&xdef);
 
         if (xdef!=NULL && xref->rtype==R_LOCALPC) {
           /* R_LOCALPC only accepts symbols which are defined in the
@@ -1187,7 +1511,7 @@ void linker_resolve(struct GlobalVars *gv)
           }
         }
         /* reference has been resolved after this point */
-        if (trace_sym_access(gv,xref->xrefname))
+        if (sc->flags & SCF_TRACE)
           fprintf(stderr,"Symbol %s referenced from %s\n",
                   xref->xrefname,getobjname(sec->obj));
 
@@ -1255,6 +1579,8 @@ void linker_resolve(struct GlobalVars *gv)
                     break;
                   case R_GOT:
                   case R_GOTPC:
+                  case R_GOTPCX:
+                  case R_GOTPCXREX:
                   case R_GOTOFF:
                   case R_PLT:
                   case R_PLTPC:
@@ -1295,6 +1621,14 @@ void linker_resolve(struct GlobalVars *gv)
           /* Handle explicit GOT and PLT references */
           if (!gv->dest_object) {
             switch (xref->rtype) {
+              case R_GOTPCX:
+              case R_GOTPCXREX:
+                if (!gv->dest_sharedobj && xdef->type==SYM_RELOC &&
+                    xdef->relsect->obj->lnkfile->type!=ID_SHAREDOBJ &&
+                    gotrelax(gv,sec,xref))
+                  break;  /* direct reference to a local symbol */
+                xref->rtype = R_GOTPC;
+                /* fall through */
               case R_GOT:
               case R_GOTPC:
               case R_GOTOFF:
@@ -1329,6 +1663,8 @@ void linker_resolve(struct GlobalVars *gv)
     obj = (struct ObjectUnit *)obj->n.next;
   }
   while (obj->n.next);
+
+  free_symcache();
 }
 
 
@@ -1348,11 +1684,10 @@ void linker_relrefs(struct GlobalVars *gv)
 
     for (sec=(struct Section *)obj->sections.first;
          sec->n.next!=NULL; sec=(struct Section *)sec->n.next) {
-      struct RelRef **rr = &sec->relrefs;
       struct Symbol *xdef;
       struct Reloc *xref,*reloc;
 
-      for (*rr=NULL,xref=(struct Reloc *)sec->xrefs.first;
+      for (xref=(struct Reloc *)sec->xrefs.first;
            xref->n.next!=NULL; xref=(struct Reloc *)xref->n.next) {
 
         /* remember offset of sections's last xref */
@@ -1370,7 +1705,7 @@ void linker_relrefs(struct GlobalVars *gv)
 
             if (xref->rtype==R_PC && xdef->relsect!=sec) {
               /* relative reference to different section */
-              addrelref(rr,xdef->relsect);
+              addrelref(sec,xdef->relsect);
             }
 
             else if (xref->rtype==R_SD || xref->rtype==R_MOSDREL) {
@@ -1391,7 +1726,20 @@ void linker_relrefs(struct GlobalVars *gv)
 
         if (reloc->rtype==R_PC && reloc->relocsect.ptr!=sec) {
           /* relative reference to different section */
-          addrelref(rr,reloc->relocsect.ptr);
+          addrelref(sec,reloc->relocsect.ptr);
+        }
+
+        else if ((reloc->rtype==R_GOTPCX || reloc->rtype==R_GOTPCXREX) &&
+                 !gv->dest_object) {
+          /* try to reference the local symbol directly, without GOT */
+          if (gotrelax(gv,sec,reloc)) {
+            if (reloc->relocsect.ptr != sec)
+              addrelref(sec,reloc->relocsect.ptr);
+          }
+          else {
+            reloc->rtype = R_GOTPC;
+            dyn_reloc_entry(gv,reloc,GOT_LOCAL);
+          }
         }
 
         else if (reloc->rtype==R_GOT || reloc->rtype==R_GOTPC) {
@@ -1524,132 +1872,964 @@ void linker_gcsects(struct GlobalVars *gv)
 }
 
 
-void linker_join(struct GlobalVars *gv)
-/* Join the sections with same name and type, or as defined by a
-   linker script. Calculate their virtual address and size. */
+static struct ObjectUnit *farcall_obj;  /* artificial unit for stubs */
+
+struct FarCall {
+  struct node n;
+  struct Section *stub;
+  void *dest;                   /* destination section or symbol */
+  lword addend;                 /* original branch addend */
+  lword stubaddend;             /* new branch addend, to reach the stub */
+  unsigned long users;          /* number of branches using the stub */
+  unsigned long lssize;         /* section size before adding the stub */
+  struct Section *sec;          /* first branch, for tracing */
+  unsigned long offset;
+};
+static struct list farcalls;
+
+struct FarRedirect {            /* branch to a section not yet placed */
+  struct node n;
+  struct Section *sec;
+  struct Reloc *r;
+  struct Reloc orig;            /* branch before redirection */
+  struct FarCall *fc;
+};
+static struct list farredirs;
+
+
+static struct Section *branch_target(struct Reloc *r)
+/* return the section a PC-relative branch is pointing to, or NULL */
 {
-  struct ObjectUnit *obj;
-  struct Section *sec,*nextsec;
-  struct LinkedSection *ls;
-  uint8_t stype;
+  if (r->xrefname) {
+    struct Symbol *xdef = r->relocsect.symbol;
 
-  if (gv->trace_file)
-    fprintf(gv->trace_file,"Joining selected sections:\n");
+    if (xdef==NULL || (r->flags & RELF_DYNLINK) || xdef->type!=SYM_RELOC)
+      return NULL;
+    return xdef->relsect;
+  }
+  return r->relocsect.ptr;
+}
 
-  if (gv->use_ldscript) {
-    /* Linkage rules are defined by a linker script, which means there */
-    /* are predefined LinkedSection structures which can be used. */
-    struct LinkedSection *maxls=NULL;
-    char *filepattern,**secpatterns;
-    unsigned long maxsize = 0;
 
-    init_secdef_parse(gv);
-    /* Handle one section definition after the other from the
-       linker script's SECTIONS block. The script parser cares
-       for commands, symbol-definitions and address-assignments. */
+static bool branch_dest(struct Reloc *r,unsigned long *dest)
+/* Determine the destination address of a PC-relative branch, before
+   its section was copied. Returns FALSE when there is none yet. */
+{
+  struct Section *sec = branch_target(r);
 
-    while (ls = next_secdef(gv)) {
-      int patalign;
+  if (sec==NULL || sec->lnksec==NULL ||
+      !(sec->lnksec->ld_flags & LSF_PLACED))
+    return FALSE;
+  if (r->xrefname)
+    *dest = sec->va + (unsigned long)(r->relocsect.symbol->value + r->addend);
+  else
+    *dest = sec->va + (unsigned long)r->addend;
+  return TRUE;
+}
 
-      /* Phase 1: read file/section patterns and determine which alignment
-         and flags are required for the sections to merge with us */
-      while (patalign = test_pattern(gv,&filepattern,&secpatterns)) {
-        if (patalign < 0) {
-          /* normal case: match selected objects with file/sec. patterns */
-          for (obj=(struct ObjectUnit *)gv->selobjects.first;
-               obj->n.next!=NULL; obj=(struct ObjectUnit *)obj->n.next) {
 
-            if (obj->lnkfile->type != ID_SHAREDOBJ &&
-                pattern_match(filepattern,obj->lnkfile->filename)) {
-              for (sec=(struct Section *)obj->sections.first;
-                   sec->n.next!=NULL; sec=(struct Section *)sec->n.next) {
-                if (sec->lnksec==NULL
-                    && patternlist_match(secpatterns,sec->name)) {
-                  /* File name and section name are matching the patterns,
-                     so try to merge and check alignments */
-                  uint8_t f;
+static unsigned long ls_farcalls(struct GlobalVars *gv,
+                                 struct LinkedSection *ls)
+/* Find PC-relative branches in a code section, which has got its
+   address, and redirect those out of range to far-call stubs, which
+   are appended to the LinkedSection. Branches into sections without an
+   address yet also get a stub, which only reserves its space until
+   check_farcalls() knows whether the destination is reachable.
+   A stub is created by the target and reused for all further branches
+   to the same destination. Returns the number of bytes added. */
+{
+  struct FarCall *fc;
+  struct FarRedirect *rd;
+  struct Section *sec,*lastsec,*tsec;
+  struct Reloc *r,*nextr;
+  unsigned long dest,oldsize;
+  bool known;
+  int xr;
+
+  if (gv->dest_object || fff[gv->dest_format]->farcall==NULL ||
+      listempty(&ls->sections))
+    return 0;
+  oldsize = ls->size;
+  lastsec = (struct Section *)ls->sections.last;
 
-                  if ((f = cmpsecflags(gv,ls,sec)) == 0xff) {
-                    /* no warning, because the linker-script should know... */
-                    f = ls->flags ? ls->flags : sec->flags;
-                  }
-                  merge_sec_attrs(ls,sec,f&~SF_PORTABLE_MASK);
-                  sec->lnksec = ls;  /* will be reset for phase 2 */
-                }
+  for (sec=(struct Section *)ls->sections.first;
+       sec!=(struct Section *)lastsec->n.next;
+       sec=(struct Section *)sec->n.next) {
+    for (xr=0; xr<2; xr++) {
+      r = (struct Reloc *)(xr ? sec->xrefs.first : sec->relocs.first);
+
+      while (nextr = (struct Reloc *)r->n.next) {
+        if (r->rtype==R_PC && (tsec = branch_target(r))!=NULL &&
+            tsec->obj!=farcall_obj &&  /* already redirected */
+            ((known = branch_dest(r,&dest)) ?
+             !checkreloc(r,sign_extend((lword)(dest-(sec->va+r->offset)),
+                                       gv->bits_per_taddr)) : TRUE)) {
+          /* out of range or unknown: look for an existing stub first */
+          for (fc=(struct FarCall *)farcalls.first;
+               fc->n.next!=NULL; fc=(struct FarCall *)fc->n.next) {
+            if (fc->stub->lnksec==ls && fc->dest==r->relocsect.ptr &&
+                fc->addend==r->addend)
+              break;
+          }
+          rd = NULL;
+          if (!known) {
+            /* remember the original branch, it may be restored */
+            rd = alloc(sizeof(struct FarRedirect));
+            rd->sec = sec;
+            rd->r = r;
+            rd->orig = *r;
+          }
+
+          if (fc->n.next == NULL) {
+            /* create a new far-call stub */
+            if (farcall_obj == NULL)
+              farcall_obj = art_objunit(gv,"FARCALLS",NULL,0);
+            fc = alloc(sizeof(struct FarCall));
+            fc->dest = r->relocsect.ptr;
+            fc->addend = r->addend;
+            fc->users = 0;
+            fc->lssize = ls->size;
+            fc->sec = sec;
+            fc->offset = r->offset;
+            fc->stub = add_section(farcall_obj,ls->name,NULL,0,ST_CODE,
+                                   SF_ALLOC,SP_READ|SP_EXEC,2,FALSE);
+
+            if (fff[gv->dest_format]->farcall(gv,fc->stub,r)) {
+              struct Section *stub = fc->stub;
+              struct Reloc *sr;
+
+              if (gv->use_ldscript) {
+                merge_ld_section(gv,ST_CODE,ls,stub);
+                ls->size = ls->relocmem->current - ls->base;
+              }
+              else {
+                unsigned long abytes = align(ls->base+ls->size,
+                                             stub->alignment);
+
+                stub->lnksec = ls;
+                stub->offset = ls->size + abytes;
+                stub->va = ls->base + stub->offset;
+                ls->size += stub->size + abytes;
+                addtail(&ls->sections,remnode(&stub->n));
               }
+              ls->filesize = ls->size;
+              for (sr=(struct Reloc *)stub->relocs.first;
+                   sr->n.next!=NULL; sr=(struct Reloc *)sr->n.next)
+                set_last_sec_reloc(stub,sr);
+              for (sr=(struct Reloc *)stub->xrefs.first;
+                   sr->n.next!=NULL; sr=(struct Reloc *)sr->n.next)
+                set_last_sec_reloc(stub,sr);
+              fc->stubaddend = r->addend;
+              addtail(&farcalls,&fc->n);
+            }
+            else {
+              remnode(&fc->stub->n);
+              free(fc->stub);
+              free(fc);
+              fc = NULL;  /* not a branch, which the target can redirect */
             }
           }
-          free_patterns(filepattern,secpatterns);
-        }
-        else {
-          /* A data command (BYTE, SHORT, etc.) defined an alignment */
-          if (patalign > ls->alignment)
-            ls->alignment = patalign;
+          else
+            r->addend = fc->stubaddend;
+
+          if (fc) {
+            /* redirect the branch to the stub */
+            if (r->xrefname) {
+              r->xrefname = NULL;
+              remnode(&r->n);
+              addtail(&sec->relocs,&r->n);
+            }
+            r->relocsect.ptr = fc->stub;
+            fc->users++;
+            if (rd) {
+              rd->fc = fc;
+              addtail(&farredirs,&rd->n);
+            }
+          }
+          else
+            free(rd);
         }
+        r = nextr;
       }
+    }
+  }
+  return ls->size - oldsize;
+}
 
-      if (ls->ld_flags & LSF_USED)
-        error(81,ls->name);  /* multiple use of section in linker script */
-
-      /* align this section to the maximum required alignment */
-      align_address(ls->relocmem,ls->destmem,ls->alignment);
-      ls->base = ls->relocmem->current;
-      ls->copybase = ls->destmem->current;
-      ls->ld_flags |= LSF_USED;
 
-      /* reset lnksec pointers for phase 2 */
-      for (obj=(struct ObjectUnit *)gv->selobjects.first;
-           obj->n.next!=NULL; obj=(struct ObjectUnit *)obj->n.next) {
-        if (obj->lnkfile->type!=ID_SHAREDOBJ && !listempty(&obj->sections)) {
-          for (sec=(struct Section *)obj->sections.first;
-               sec->n.next!=NULL; sec=(struct Section *)sec->n.next)
-            sec->lnksec = NULL;
-        }
+static void drop_farcalls(struct GlobalVars *gv)
+/* All sections are placed now. Restore the branches into sections,
+   which had no address when their stub was made, when they reach their
+   destination directly. Stubs without any branch are removed again. */
+{
+  struct FarRedirect *rd;
+  struct FarCall *fc,*predfc;
+  struct LinkedSection *ls;
+  struct Reloc *r,cur;
+  unsigned long dest;
+
+  while (rd = (struct FarRedirect *)remhead(&farredirs)) {
+    r = rd->r;
+    cur = *r;
+    r->xrefname = rd->orig.xrefname;
+    r->relocsect = rd->orig.relocsect;
+    r->addend = rd->orig.addend;
+    if (branch_dest(r,&dest) &&
+        checkreloc(r,sign_extend((lword)(dest-(rd->sec->va+r->offset)),
+                                 gv->bits_per_taddr))) {
+      if (r->xrefname) {
+        remnode(&r->n);
+        addtail(&rd->sec->xrefs,&r->n);
       }
+      rd->fc->users--;
+    }
+    else {
+      r->xrefname = cur.xrefname;
+      r->relocsect = cur.relocsect;
+      r->addend = cur.addend;
+    }
+    free(rd);
+  }
 
-      /* The linker scripts create an empty dummy section and adds */
-      /* it as the first section into the LinkedSection's list. */
-      /* Its purpose is to keep all linker script symbols. */
-      /* We have to make sure that its lnksec and va is valid. */
-      if (!listempty(&ls->sections)) {
-        sec = (struct Section *)ls->sections.first;
-        sec->filldata = gv->filldata;
-        sec->lnksec = ls;
-        sec->va = ls->relocmem->current;
+  /* remove unused stubs, latest first, to release space at the end */
+  for (fc=(struct FarCall *)farcalls.last; fc->n.pred!=NULL; fc=predfc) {
+    predfc = (struct FarCall *)fc->n.pred;
+    if (fc->users == 0) {
+      ls = fc->stub->lnksec;
+      if (ls->sections.last == &fc->stub->n) {
+        ls->size = fc->lssize;
+        if (ls->filesize > ls->size)
+          ls->filesize = ls->size;
       }
+      remnode(&fc->stub->n);
+      free(fc->stub);
+      remnode(&fc->n);
+      free(fc);
+    }
+  }
+}
 
-      /* Phase 2: read next patterns and merge matching sections for real */
-      while ((sec = next_pattern(gv,&filepattern,&secpatterns)) != NULL) {
-        if (sec == VALIDPAT) {
-          /* For each pattern, merge ST_CODE first, then ST_DATA and */
-          /* ST_UDATA at last, to keep uninitialized sections together. */
-          for (stype=0; stype<=ST_LAST; stype++) {
-            for (obj=(struct ObjectUnit *)gv->selobjects.first;
-                 obj->n.next!=NULL; obj=(struct ObjectUnit *)obj->n.next) {
-
-              if (obj->lnkfile->type != ID_SHAREDOBJ &&
-                  pattern_match(filepattern,obj->lnkfile->filename)) {
-                sec = (struct Section *)obj->sections.first;
-                while (nextsec = (struct Section *)sec->n.next) {
-                  if (sec->lnksec==NULL && sec->type==stype &&
-                      patternlist_match(secpatterns,sec->name)) {
-                    /* File name and section name are matching the patterns,
-                       so join it into the current LinkedSection. */
-                    merge_ld_section(gv,stype,ls,sec);
-                  }
-                  sec = nextsec;
-                }
-              }
-            }
-          }
-          free_patterns(filepattern,secpatterns);
-        }
-        else { /* merge art. section created by a data command */
-          merge_ld_section(gv,~0,ls,sec);
-          if (ls->type == ST_UNDEFINED)
-            ls->type = ST_DATA;   /* sect. becomes data due to data elements */
-          ls->flags |= SF_ALLOC;  /* @@@ data should allocate the section */
-        }
+
+static bool add_farcalls(struct GlobalVars *gv)
+/* Create far-call stubs for the branches out of range in all code
+   sections. Returns TRUE when stubs were added, which requires to
+   place the sections again. */
+{
+  struct LinkedSection *ls;
+  unsigned long n = 0;
+
+  for (ls=(struct LinkedSection *)gv->lnksec.first;
+       ls->n.next!=NULL; ls=(struct LinkedSection *)ls->n.next) {
+    if (ls->type == ST_CODE)
+      n += ls_farcalls(gv,ls);
+  }
+  return n != 0;
+}
+
+
+static void check_farcalls(struct GlobalVars *gv)
+/* Make sure that all redirected branches reach their far-call stubs
+   and that the stubs don't overlap with a following section. Then the
+   artificial object unit with the stubs is enqueued. */
+{
+  struct LinkedSection *ls,*ls2;
+  struct Section *sec,*stub;
+  struct FarCall *fc;
+  struct Reloc *r;
+  unsigned long start,end;
+
+  if (farcall_obj == NULL)
+    return;
+  drop_farcalls(gv);
+
+  while (fc = (struct FarCall *)remhead(&farcalls)) {
+    if (gv->trace_file)
+      fprintf(gv->trace_file,"Far-call stub for %s(%s+%lx) at %lx\n",
+              getobjname(fc->sec->obj),fc->sec->name,fc->offset,
+              fc->stub->va);
+    free(fc);
+  }
+
+  for (ls=(struct LinkedSection *)gv->lnksec.first;
+       ls->n.next!=NULL; ls=(struct LinkedSection *)ls->n.next) {
+    if (ls->type != ST_CODE)
+      continue;
+    start = end = ls->base + ls->size;
+
+    for (sec=(struct Section *)ls->sections.first;
+         sec->n.next!=NULL; sec=(struct Section *)sec->n.next) {
+      if (sec->obj == farcall_obj) {
+        if (sec->va < start)
+          start = sec->va;
+        continue;
+      }
+      for (r=(struct Reloc *)sec->relocs.first;
+           r->n.next!=NULL; r=(struct Reloc *)r->n.next) {
+        if (r->rtype==R_PC && (stub = r->relocsect.ptr)!=NULL &&
+            stub->obj==farcall_obj &&
+            !checkreloc(r,sign_extend((lword)(stub->va+r->addend-
+                                              (sec->va+r->offset)),
+                                      gv->bits_per_taddr)))
+          error(160,getobjname(sec->obj),sec->name,r->offset);
+      }
+    }
+
+    if (start < end) {
+      /* make sure the stubs didn't grow into another section */
+      for (ls2=(struct LinkedSection *)gv->lnksec.first;
+           ls2->n.next!=NULL; ls2=(struct LinkedSection *)ls2->n.next) {
+        if (ls2!=ls && ls2->size!=0 && ls2->base>=start && ls2->base<end)
+          error(153,ls->name,ls2->name);
+      }
+    }
+  }
+
+  /* enqueue artificial object unit into linking process */
+  farcall_obj->lnkfile->type = ID_OBJECT;
+  add_objunit(gv,farcall_obj,FALSE);
+}
+
+
+static unsigned long rank_symorder(struct GlobalVars *gv)
+/* Rank the code sections by the symbols of the ordering file. Each line
+   contains a symbol name, optionally followed by its call count. Without
+   counts the order of the file is kept, otherwise the most frequently
+   called functions come first. Returns the number of ranks used. */
+{
+  struct SortKey *keys = NULL;
+  struct SymNames **htab,*sn;
+  struct ObjectUnit *obj;
+  struct Section *sec;
+  struct Symbol *sym;
+  unsigned long n=0,max=0,nsecs=0,hsize,i;
+  const char *p = gv->symorder;
+  const char *s;
+  char *name,*e;
+
+  while (*p) {
+    unsigned long long cnt = 0;
+
+    while (isspace((unsigned char)*p))
+      p++;
+    if (*p == '#') {  /* comment */
+      while (*p && *p!='\n')
+        p++;
+      continue;
+    }
+    for (s=p; *p && !isspace((unsigned char)*p); p++);
+    if (p == s)
+      continue;
+    name = alloc(p-s+1);
+    memcpy(name,s,p-s);
+    name[p-s] = 0;
+    while (*p==' ' || *p=='\t')
+      p++;
+    if (isdigit((unsigned char)*p)) {
+      cnt = strtoull(p,&e,0);
+      p = e;
+    }
+    while (*p && *p!='\n')
+      p++;
+
+    if (n >= max) {
+      max = max ? max<<1 : 64;
+      keys = re_alloc(keys,max*sizeof(struct SortKey));
+    }
+    sn = alloc(sizeof(struct SymNames));
+    sn->name = name;
+    keys[n].key = ~(uint64_t)cnt;  /* highest count first */
+    keys[n++].ptr = sn;
+  }
+  if (n == 0)
+    return 0;
+  radix_sort(keys,n);
+
+  for (hsize=0x100; hsize<n; hsize<<=1);
+  htab = alloc_hashtable(hsize);
+  for (i=0; i<n; i++) {
+    struct SymNames **chain;
+
+    sn = (struct SymNames *)keys[i].ptr;
+    sn->value = i + 1;
+    for (chain=&htab[elf_hash(sn->name)&(hsize-1)]; *chain;
+         chain=&(*chain)->next) {
+      if (!strcmp((*chain)->name,sn->name))
+        break;  /* keep the first rank of a duplicate name */
+    }
+    if (*chain == NULL) {
+      sn->next = NULL;
+      *chain = sn;
+    }
+  }
+
+  /* a section gets the best rank of all the symbols it defines */
+  for (obj=(struct ObjectUnit *)gv->selobjects.first;
+       obj->n.next!=NULL; obj=(struct ObjectUnit *)obj->n.next) {
+    if (obj->lnkfile->type == ID_SHAREDOBJ)
+      continue;
+    for (i=0; i<OBJSYMHTABSIZE; i++) {
+      for (sym=obj->objsyms[i]; sym; sym=sym->obj_chain) {
+        if (sym->type!=SYM_RELOC || (sec=sym->relsect)==NULL ||
+            sec->type!=ST_CODE)
+          continue;
+        for (sn=htab[elf_hash(sym->name)&(hsize-1)]; sn; sn=sn->next) {
+          if (!strcmp(sn->name,sym->name)) {
+            if (sec->order == 0)
+              nsecs++;
+            if (sec->order==0 || (uint32_t)sn->value<sec->order)
+              sec->order = (uint32_t)sn->value;
+            break;
+          }
+        }
+      }
+    }
+  }
+  if (gv->trace_file)
+    fprintf(gv->trace_file,"Ordering %lu code sections by %s\n",
+            nsecs,gv->symorder_name);
+
+  for (i=0; i<n; i++) {
+    sn = (struct SymNames *)keys[i].ptr;
+    free((char *)sn->name);
+    free(sn);
+  }
+  free(htab);
+  free(keys);
+  return n;
+}
+
+
+static long cg_index(struct SortKey *secs,unsigned long n,struct Section *sec)
+/* binary search for a section in the array, sorted by address */
+{
+  uint64_t k = (uint64_t)(uintptr_t)sec;
+  unsigned long lo=0,hi=n,m;
+
+  while (lo < hi) {
+    m = (lo + hi) >> 1;
+    if (secs[m].key < k)
+      lo = m + 1;
+    else
+      hi = m;
+  }
+  return (lo<n && secs[lo].ptr==sec) ? (long)lo : -1;
+}
+
+
+static unsigned long cg_root(unsigned long *parent,unsigned long i)
+{
+  while (parent[i] != i)
+    i = parent[i] = parent[parent[i]];
+  return i;
+}
+
+
+static void rank_callgraph(struct GlobalVars *gv,unsigned long rank)
+/* Rank the remaining code sections by their references to each other.
+   The sections with the most references between them are clustered
+   first, placing the referenced section behind the referencing one,
+   so calls tend to stay within the same pages. */
+{
+  struct CGEdge {
+    unsigned long from,to,weight;
+  } *edges;
+  struct SortKey *secs=NULL,*refs=NULL,*ekeys;
+  struct ObjectUnit *obj;
+  struct Section *sec,*dest;
+  struct Reloc *r;
+  unsigned long nsecs=0,maxsecs=0,nrefs=0,maxrefs=0,nedges=0,nord=0;
+  unsigned long *parent,*next,*last,i,j;
+  long k;
+  int xr;
+
+  for (obj=(struct ObjectUnit *)gv->selobjects.first;
+       obj->n.next!=NULL; obj=(struct ObjectUnit *)obj->n.next) {
+    if (obj->lnkfile->type == ID_SHAREDOBJ)
+      continue;
+    for (sec=(struct Section *)obj->sections.first;
+         sec->n.next!=NULL; sec=(struct Section *)sec->n.next) {
+      if (sec->type==ST_CODE && sec->order==0) {
+        if (nsecs >= maxsecs) {
+          maxsecs = maxsecs ? maxsecs<<1 : 64;
+          secs = re_alloc(secs,maxsecs*sizeof(struct SortKey));
+        }
+        secs[nsecs].key = (uint64_t)(uintptr_t)sec;
+        secs[nsecs++].ptr = sec;
+      }
+    }
+  }
+  if (nsecs < 2) {
+    free(secs);
+    return;
+  }
+  radix_sort(secs,nsecs);
+
+  /* collect a key for each reference between two different sections */
+  for (i=0; i<nsecs; i++) {
+    sec = (struct Section *)secs[i].ptr;
+    for (xr=0; xr<2; xr++) {
+      for (r=(struct Reloc *)(xr ? sec->xrefs.first : sec->relocs.first);
+           r->n.next!=NULL; r=(struct Reloc *)r->n.next) {
+        if (xr)
+          dest = r->relocsect.symbol ? r->relocsect.symbol->relsect : NULL;
+        else
+          dest = r->relocsect.ptr;
+        if (dest==NULL || dest==sec || dest->type!=ST_CODE ||
+            (k = cg_index(secs,nsecs,dest)) < 0)
+          continue;
+        if (nrefs >= maxrefs) {
+          maxrefs = maxrefs ? maxrefs<<1 : 64;
+          refs = re_alloc(refs,maxrefs*sizeof(struct SortKey));
+        }
+        refs[nrefs].key = ((uint64_t)i << 32) | (uint64_t)k;
+        refs[nrefs++].ptr = NULL;
+      }
+    }
+  }
+
+  if (nrefs) {
+    /* count the references between each pair of sections */
+    radix_sort(refs,nrefs);
+    edges = alloc(nrefs * sizeof(struct CGEdge));
+    for (i=0; i<nrefs; i=j) {
+      for (j=i+1; j<nrefs && refs[j].key==refs[i].key; j++);
+      edges[nedges].from = (unsigned long)(refs[i].key >> 32);
+      edges[nedges].to = (unsigned long)(refs[i].key & 0xffffffff);
+      edges[nedges++].weight = j - i;
+    }
+    ekeys = alloc(nedges * sizeof(struct SortKey));
+    for (i=0; i<nedges; i++) {
+      ekeys[i].key = ~(uint64_t)edges[i].weight;  /* heaviest first */
+      ekeys[i].ptr = &edges[i];
+    }
+    radix_sort(ekeys,nedges);
+
+    /* Merge clusters, appending the referenced one. A cluster's root
+       is always its first section. */
+    parent = alloc(3 * nsecs * sizeof(unsigned long));
+    next = parent + nsecs;
+    last = next + nsecs;
+    for (i=0; i<nsecs; i++) {
+      parent[i] = last[i] = i;
+      next[i] = nsecs;
+    }
+    for (i=0; i<nedges; i++) {
+      struct CGEdge *e = (struct CGEdge *)ekeys[i].ptr;
+      unsigned long a = cg_root(parent,e->from);
+      unsigned long b = cg_root(parent,e->to);
+
+      if (a != b) {
+        next[last[a]] = b;
+        last[a] = last[b];
+        parent[b] = a;
+      }
+    }
+
+    /* emit the clusters in the order of their heaviest reference */
+    for (i=0; i<nedges; i++) {
+      struct CGEdge *e = (struct CGEdge *)ekeys[i].ptr;
+
+      j = cg_root(parent,e->from);
+      if (((struct Section *)secs[j].ptr)->order == 0) {
+        for (; j<nsecs; j=next[j]) {
+          ((struct Section *)secs[j].ptr)->order = (uint32_t)++rank;
+          nord++;
+        }
+      }
+    }
+    free(parent);
+    free(ekeys);
+    free(edges);
+  }
+  if (gv->trace_file)
+    fprintf(gv->trace_file,"Ordering %lu code sections by call graph\n",
+            nord);
+  free(refs);
+  free(secs);
+}
+
+
+static void section_keys(struct SortKey *keys,unsigned long n)
+/* make keys to sort sections by rank, with unranked sections last and
+   uninitialized sections behind all others */
+{
+  struct Section *sec;
+  unsigned long i;
+
+  for (i=0; i<n; i++) {
+    sec = (struct Section *)keys[i].ptr;
+    keys[i].key = sec->order ? sec->order : 0xffffffff;
+    if (sec->flags & SF_UNINITIALIZED)
+      keys[i].key |= (uint64_t)1 << 32;
+  }
+}
+
+
+static unsigned long padding(struct SortKey *keys,unsigned long n,
+                             unsigned long addr)
+/* return the alignment gaps between the sections, starting at addr */
+{
+  struct Section *sec;
+  unsigned long pad=0,a,i;
+
+  for (i=0; i<n; i++) {
+    sec = (struct Section *)keys[i].ptr;
+    a = align(addr,sec->alignment);
+    pad += a;
+    addr += a + sec->size;
+  }
+  return pad;
+}
+
+
+static unsigned long pack_sections(struct SortKey *keys,unsigned long n,
+                                   unsigned long addr)
+/* Place the sections one after another, choosing the next section of
+   the alignment which needs the least padding at the current address,
+   preferring higher alignments. Sections with the same alignment keep
+   their order. Returns the address behind the last section. */
+{
+  struct SortKey *tmp;
+  struct Section *sec;
+  unsigned long pos[256],pad,bestpad=0,i,j;
+  int a,besta,maxa=0;
+
+  tmp = alloc(n * sizeof(struct SortKey));
+  memcpy(tmp,keys,n*sizeof(struct SortKey));
+  for (a=0; a<256; a++)
+    pos[a] = n;
+  for (i=n; i>0; i--) {  /* first section of each alignment */
+    a = ((struct Section *)tmp[i-1].ptr)->alignment;
+    pos[a] = i - 1;
+    if (a > maxa)
+      maxa = a;
+  }
+
+  for (i=0; i<n; i++) {
+    for (a=maxa,besta=-1; a>=0; a--) {
+      if (pos[a] < n) {
+        pad = align(addr,a);
+        if (besta<0 || pad<bestpad) {
+          besta = a;
+          bestpad = pad;
+        }
+      }
+    }
+    j = pos[besta];
+    keys[i] = tmp[j];
+    sec = (struct Section *)tmp[j].ptr;
+    addr += bestpad + sec->size;
+    for (j++; j<n && ((struct Section *)tmp[j].ptr)->alignment!=besta; j++);
+    pos[besta] = j;
+  }
+  free(tmp);
+  return addr;
+}
+
+
+static bool packable(struct Section *sec)
+/* Sections with relative references to other sections and fragments of
+   the initialization and constructor/destructor tables keep their
+   order. */
+{
+  static const char *fixed[] = { ".init",".fini",ctors_name,dtors_name };
+  size_t i,len;
+
+  if (sec->relgroup != NULL)
+    return FALSE;
+  for (i=0; i<sizeof(fixed)/sizeof(fixed[0]); i++) {
+    len = strlen(fixed[i]);
+    if (!strncmp(sec->name,fixed[i],len) &&
+        (sec->name[len]=='\0' || sec->name[len]=='.'))
+      return FALSE;
+  }
+  return TRUE;
+}
+
+
+static unsigned long sort_sections(struct SortKey *keys,unsigned long n,
+                                   unsigned long addr,bool pack)
+/* Stable sort of sections by rank. With pack, sections of the same rank
+   are packed, when this needs less padding from addr on, except those
+   which are not packable(). Returns the number of bytes saved. */
+{
+  struct SortKey *packed;
+  unsigned long before,after,a,i,j;
+
+  section_keys(keys,n);
+  radix_sort(keys,n);
+  if (!pack)
+    return 0;
+
+  packed = alloc(n * sizeof(struct SortKey));
+  memcpy(packed,keys,n*sizeof(struct SortKey));
+  for (i=0,a=addr; i<n; i=j) {
+    struct Section *sec = (struct Section *)packed[i].ptr;
+
+    if (!packable(sec)) {
+      /* stays in place, pack the sections before and behind it */
+      a += align(a,sec->alignment) + sec->size;
+      j = i + 1;
+      continue;
+    }
+    for (j=i+1; j<n && packed[j].key==packed[i].key &&
+         packable((struct Section *)packed[j].ptr); j++);
+    a = pack_sections(packed+i,j-i,a);
+  }
+  before = padding(keys,n,addr);
+  after = padding(packed,n,addr);
+  if (after < before)
+    memcpy(keys,packed,n*sizeof(struct SortKey));
+  free(packed);
+  return after<before ? before-after : 0;
+}
+
+
+static unsigned long order_lnksec(struct LinkedSection *ls,bool pack)
+/* Reorder the sections of a LinkedSection by rank, and pack them by
+   alignment when requested. The first code section stays in place,
+   as it usually contains the entry point. Returns bytes saved. */
+{
+  struct Section *first,*sec;
+  struct SortKey *keys;
+  unsigned long n=0,i,addr=0,saved;
+
+  if (listempty(&ls->sections))
+    return 0;
+  first = NULL;
+  if (ls->type == ST_CODE) {
+    first = (struct Section *)ls->sections.first;
+    addr = first->size;
+  }
+  for (sec=(struct Section *)ls->sections.first;
+       sec->n.next!=NULL; sec=(struct Section *)sec->n.next) {
+    if (sec != first)
+      n++;
+  }
+  if (n < 2)
+    return 0;
+
+  keys = alloc(n * sizeof(struct SortKey));
+  for (i=0; i<n; i++) {
+    sec = (struct Section *)(first ? first->n.next : ls->sections.first);
+    remnode(&sec->n);
+    keys[i].ptr = sec;
+  }
+  saved = sort_sections(keys,n,addr,pack);
+  for (i=0; i<n; i++)
+    addtail(&ls->sections,&((struct Section *)keys[i].ptr)->n);
+  free(keys);
+  return saved;
+}
+
+
+static void place_lnksecs(struct GlobalVars *gv)
+/* calculate offsets and sizes of all LinkedSections for the default
+   linkage rules, may be repeated after adding far-call stubs */
+{
+  unsigned long va = gv->start_addr;
+  bool baseincr = (fff[gv->dest_format]->flags&FFF_BASEINCR) != 0;
+  struct LinkedSection *ls;
+  struct Section *sec;
+
+  for (ls=(struct LinkedSection *)gv->lnksec.first;
+       ls->n.next!=NULL; ls=(struct LinkedSection *)ls->n.next) {
+    ls->base = ls->copybase = va;
+    ls->size = ls->filesize = 0;
+
+    for (sec=(struct Section *)ls->sections.first;
+         sec->n.next!=NULL; sec=(struct Section *)sec->n.next) {
+      unsigned long abytes = align(ls->base+ls->size,sec->alignment);
+
+      sec->lnksec = ls;
+      sec->offset = ls->size + abytes;
+      sec->va = ls->base + sec->offset;
+      ls->size += sec->size + abytes;
+      if (baseincr)
+        va += sec->size + abytes;
+      if (!(sec->flags & SF_UNINITIALIZED))
+        ls->filesize += sec->size + abytes;
+
+      /* allocate COMMON symbols, if required */
+      if (is_common_sec(gv,sec) &&
+          (!gv->dest_object || gv->alloc_common)) {
+        unsigned long n = allocate_common(gv,sec,ls->base+ls->size);
+
+        ls->size += n;
+        if (baseincr)
+          va += n;
+      }
+    }
+    ls->ld_flags |= LSF_PLACED;
+  }
+}
+
+
+void linker_join(struct GlobalVars *gv)
+/* Join the sections with same name and type, or as defined by a
+   linker script. Calculate their virtual address and size. */
+{
+  struct ObjectUnit *obj;
+  struct Section *sec,*nextsec;
+  struct LinkedSection *ls;
+  bool ordered = gv->symorder!=NULL || gv->callgraph_order;
+  bool pack = gv->pack_sections && !gv->keep_sect_order;
+  unsigned long nranks = 0;
+  uint8_t stype;
+
+  farcall_obj = NULL;
+  initlist(&farcalls);
+  initlist(&farredirs);
+  if (gv->symorder)
+    nranks = rank_symorder(gv);
+  if (gv->callgraph_order)
+    rank_callgraph(gv,nranks);
+
+  if (gv->trace_file)
+    fprintf(gv->trace_file,"Joining selected sections:\n");
+
+  if (gv->use_ldscript) {
+    /* Linkage rules are defined by a linker script, which means there */
+    /* are predefined LinkedSection structures which can be used. */
+    struct LinkedSection *maxls=NULL;
+    char *filepattern,**secpatterns;
+    unsigned long maxsize = 0;
+    struct SortKey *keys = NULL;
+    unsigned long nkeys,maxkeys=0,saved,i;
+
+    init_secdef_parse(gv);
+    /* Handle one section definition after the other from the
+       linker script's SECTIONS block. The script parser cares
+       for commands, symbol-definitions and address-assignments. */
+
+    while (ls = next_secdef(gv)) {
+      int patalign;
+
+      /* Phase 1: read file/section patterns and determine which alignment
+         and flags are required for the sections to merge with us */
+      while (patalign = test_pattern(gv,&filepattern,&secpatterns)) {
+        if (patalign < 0) {
+          /* normal case: match selected objects with file/sec. patterns */
+          for (obj=(struct ObjectUnit *)gv->selobjects.first;
+               obj->n.next!=NULL; obj=(struct ObjectUnit *)obj->n.next) {
+
+            if (obj->lnkfile->type != ID_SHAREDOBJ &&
+                pattern_match(filepattern,obj->lnkfile->filename)) {
+              for (sec=(struct Section *)obj->sections.first;
+                   sec->n.next!=NULL; sec=(struct Section *)sec->n.next) {
+                if (sec->lnksec==NULL
+                    && patternlist_match(secpatterns,sec->name)) {
+                  /* File name and section name are matching the patterns,
+                     so try to merge and check alignments */
+                  uint8_t f;
+
+                  if ((f = cmpsecflags(gv,ls,sec)) == 0xff) {
+                    /* no warning, because the linker-script should know... */
+                    f = ls->flags ? ls->flags : sec->flags;
+                  }
+                  merge_sec_attrs(ls,sec,f&~SF_PORTABLE_MASK);
+                  sec->lnksec = ls;  /* will be reset for phase 2 */
+                }
+              }
+            }
+          }
+        }
+        else {
+          /* A data command (BYTE, SHORT, etc.) defined an alignment */
+          if (patalign > ls->alignment)
+            ls->alignment = patalign;
+        }
+      }
+
+      if (ls->ld_flags & LSF_USED)
+        error(81,ls->name);  /* multiple use of section in linker script */
+
+      /* align this section to the maximum required alignment */
+      align_address(ls->relocmem,ls->destmem,ls->alignment);
+      ls->base = ls->relocmem->current;
+      ls->copybase = ls->destmem->current;
+      ls->ld_flags |= LSF_USED;
+
+      /* reset lnksec pointers for phase 2 */
+      for (obj=(struct ObjectUnit *)gv->selobjects.first;
+           obj->n.next!=NULL; obj=(struct ObjectUnit *)obj->n.next) {
+        if (obj->lnkfile->type!=ID_SHAREDOBJ && !listempty(&obj->sections)) {
+          for (sec=(struct Section *)obj->sections.first;
+               sec->n.next!=NULL; sec=(struct Section *)sec->n.next)
+            sec->lnksec = NULL;
+        }
+      }
+
+      /* The linker scripts create an empty dummy section and adds */
+      /* it as the first section into the LinkedSection's list. */
+      /* Its purpose is to keep all linker script symbols. */
+      /* We have to make sure that its lnksec and va is valid. */
+      if (!listempty(&ls->sections)) {
+        sec = (struct Section *)ls->sections.first;
+        sec->filldata = gv->filldata;
+        sec->lnksec = ls;
+        sec->va = ls->relocmem->current;
+      }
+
+      /* Phase 2: read next patterns and merge matching sections for real */
+      saved = 0;
+      while ((sec = next_pattern(gv,&filepattern,&secpatterns)) != NULL) {
+        if (sec == VALIDPAT) {
+          /* For each pattern, merge ST_CODE first, then ST_DATA and */
+          /* ST_UDATA at last, to keep uninitialized sections together. */
+          for (stype=0; stype<=ST_LAST; stype++) {
+            nkeys = 0;
+            for (obj=(struct ObjectUnit *)gv->selobjects.first;
+                 obj->n.next!=NULL; obj=(struct ObjectUnit *)obj->n.next) {
+
+              if (obj->lnkfile->type != ID_SHAREDOBJ &&
+                  pattern_match(filepattern,obj->lnkfile->filename)) {
+                sec = (struct Section *)obj->sections.first;
+                while (nextsec = (struct Section *)sec->n.next) {
+                  if (sec->lnksec==NULL && sec->type==stype &&
+                      patternlist_match(secpatterns,sec->name)) {
+                    /* File name and section name are matching the patterns,
+                       so join it into the current LinkedSection. */
+                    if (pack || (ordered && stype==ST_CODE)) {
+                      /* merged in ranked or packed order, below */
+                      if (nkeys >= maxkeys) {
+                        maxkeys = maxkeys ? maxkeys<<1 : 64;
+                        keys = re_alloc(keys,maxkeys*sizeof(struct SortKey));
+                      }
+                      keys[nkeys++].ptr = sec;
+                    }
+                    else
+                      merge_ld_section(gv,stype,ls,sec);
+                  }
+                  sec = nextsec;
+                }
+              }
+            }
+
+            if (nkeys) {
+              i = 0;
+              if (stype == ST_CODE) {
+                /* the first real code section of the output section stays
+                   in place, as it usually contains the entry point */
+                for (sec=(struct Section *)ls->sections.first;
+                     sec->n.next!=NULL && is_ld_script(sec->obj);
+                     sec=(struct Section *)sec->n.next);
+                if (sec->n.next == NULL)
+                  merge_ld_section(gv,stype,ls,keys[i++].ptr);
+              }
+              saved += sort_sections(keys+i,nkeys-i,
+                                     ls->relocmem->current,pack);
+              for (; i<nkeys; i++)
+                merge_ld_section(gv,stype,ls,keys[i].ptr);
+            }
+          }
+        }
+        else { /* merge art. section created by a data command */
+          merge_ld_section(gv,~0,ls,sec);
+          if (ls->type == ST_UNDEFINED)
+            ls->type = ST_DATA;   /* sect. becomes data due to data elements */
+          ls->flags |= SF_ALLOC;  /* @@@ data should allocate the section */
+        }
 
         /* keep section size up to date */
         if (ls->relocmem->current - ls->base > ls->size)
@@ -1664,8 +2844,18 @@ void linker_join(struct GlobalVars *gv)
           maxls = ls;
         }
       }
+      if (saved && gv->trace_file)
+        fprintf(gv->trace_file,"Packing %s saved %lu bytes\n",
+                ls->name,saved);
+
+      /* address is final, reserve space for far-call stubs behind it */
+      ls->ld_flags |= LSF_PLACED;
+      if (ls->type == ST_CODE)
+        ls_farcalls(gv,ls);
     }
 
+    free(keys);
+
     /* Check if there are any sections left, which were not recognized */
     /* by the linker script rules */
     for (obj=(struct ObjectUnit *)gv->selobjects.first;
@@ -1711,8 +2901,6 @@ void linker_join(struct GlobalVars *gv)
 
   else {  /* !gv->use_ldscript */
     /* Default linkage rules. Link all code, all data, all bss. */
-    unsigned long va = gv->start_addr;
-    bool baseincr = (fff[gv->dest_format]->flags&FFF_BASEINCR) != 0;
     struct LinkedSection *ls,*newls;
     struct list seclist;
 
@@ -1764,7 +2952,7 @@ void linker_join(struct GlobalVars *gv)
            ls->n.next!=NULL; ls=(struct LinkedSection *)ls->n.next) {
         for (sec=(struct Section *)ls->sections.first;
              sec->n.next!=NULL; sec=(struct Section *)sec->n.next) {
-          if (newls = get_matching_lnksec(gv,sec,ls)) {
+          if (newls = get_matching_lnksec(gv,sec,ls,NULL,0)) {
             /* another LinkedSection matches too - merge them! */
             break;
           }
@@ -1785,6 +2973,8 @@ void linker_join(struct GlobalVars *gv)
 
           while (sec = (struct Section *)remhead(&ls->sections)) {
             merge_sec_attrs(newls,sec,tgtfl);
+            if (sec->relgroup!=NULL && relgroup_root(sec)->grouplnk==ls)
+              relgroup_root(sec)->grouplnk = newls;
             if (!(sec->flags & SF_UNINITIALIZED) && firstbss!=NULL)
               insertbefore(&sec->n,&firstbss->n);
             else
@@ -1798,37 +2988,30 @@ void linker_join(struct GlobalVars *gv)
     }
     while (newls);
 
-    /* Phase 3: calculate offsets and sizes for final LinkedSections */
-    for (ls=(struct LinkedSection *)gv->lnksec.first;
-         ls->n.next!=NULL; ls=(struct LinkedSection *)ls->n.next) {
-      ls->base = ls->copybase = va;
-
-      for (sec=(struct Section *)ls->sections.first;
-           sec->n.next!=NULL; sec=(struct Section *)sec->n.next) {
-        unsigned long abytes = align(ls->base+ls->size,sec->alignment);
+    if (ordered || pack) {
+      /* place the ranked code sections first, pack sections by alignment */
+      for (ls=(struct LinkedSection *)gv->lnksec.first;
+           ls->n.next!=NULL; ls=(struct LinkedSection *)ls->n.next) {
+        if (pack || ls->type==ST_CODE) {
+          unsigned long saved = order_lnksec(ls,pack);
 
-        sec->lnksec = ls;
-        sec->offset = ls->size + abytes;
-        sec->va = ls->base + sec->offset;
-        ls->size += sec->size + abytes;
-        if (baseincr)
-          va += sec->size + abytes;
-        if (!(sec->flags & SF_UNINITIALIZED))
-          ls->filesize += sec->size + abytes;
-
-        /* allocate COMMON symbols, if required */
-        if (is_common_sec(gv,sec) &&
-            (!gv->dest_object || gv->alloc_common)) {
-          unsigned long n = allocate_common(gv,sec,ls->base+ls->size);
-
-          ls->size += n;
-          if (baseincr)
-            va += n;
+          if (saved && gv->trace_file)
+            fprintf(gv->trace_file,"Packing %s saved %lu bytes\n",
+                    ls->name,saved);
         }
       }
     }
+
+    /* Phase 3: calculate offsets and sizes for final LinkedSections,
+       then add far-call stubs and place everything again, until all
+       branches reach their destination */
+    do
+      place_lnksecs(gv);
+    while (add_farcalls(gv));
+    print_commons(gv);
   }
 
+  check_farcalls(gv);  /* all branches must reach their far-call stubs */
   trim_sections(gv);  /* remove zero-bytes at end of sections */
 }
 
@@ -1872,6 +3055,274 @@ void linker_delunused(struct GlobalVars *gv)
 }
 
 
+struct MapSec {
+  struct Section *sec;
+  unsigned long idx;            /* position in the linked sections */
+};
+
+static int mapsec_cmp(const void *left,const void *right)
+/* qsort: compare object units, then position */
+{
+  const struct MapSec *ms1 = (const struct MapSec *)left;
+  const struct MapSec *ms2 = (const struct MapSec *)right;
+  uintptr_t o1 = (uintptr_t)ms1->sec->obj;
+  uintptr_t o2 = (uintptr_t)ms2->sec->obj;
+
+  if (o1 != o2)
+    return o1 < o2 ? -1 : 1;
+  return ms1->idx < ms2->idx ? -1 : (ms1->idx > ms2->idx ? 1 : 0);
+}
+
+
+static struct MapSec *first_mapsec(struct MapSec *ms,unsigned long cnt,
+                                   struct ObjectUnit *obj)
+/* binary search for the first section from obj in the sorted array */
+{
+  unsigned long lo=0,hi=cnt;
+
+  while (lo < hi) {
+    unsigned long mid = (lo+hi) / 2;
+
+    if ((uintptr_t)ms[mid].sec->obj < (uintptr_t)obj)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo<cnt && ms[lo].sec->obj==obj ? &ms[lo] : NULL;
+}
+
+
+static struct MapSec *sorted_mapsecs(struct GlobalVars *gv,
+                                     unsigned long *cntp)
+/* Make an array of all linked input sections, sorted by their object
+   units, keeping the order of sections within the same object. */
+{
+  struct LinkedSection *ls;
+  struct Section *sec;
+  struct MapSec *msarray;
+  unsigned long cnt = 0;
+
+  for (ls=(struct LinkedSection *)gv->lnksec.first;
+       ls->n.next!=NULL; ls=(struct LinkedSection *)ls->n.next) {
+    for (sec=(struct Section *)ls->sections.first;
+         sec->n.next!=NULL; sec=(struct Section *)sec->n.next)
+      cnt++;
+  }
+  msarray = alloc((cnt ? cnt : 1) * sizeof(struct MapSec));
+  cnt = 0;
+  for (ls=(struct LinkedSection *)gv->lnksec.first;
+       ls->n.next!=NULL; ls=(struct LinkedSection *)ls->n.next) {
+    for (sec=(struct Section *)ls->sections.first;
+         sec->n.next!=NULL; sec=(struct Section *)sec->n.next) {
+      msarray[cnt].sec = sec;
+      msarray[cnt].idx = cnt;
+      cnt++;
+    }
+  }
+  qsort(msarray,cnt,sizeof(struct MapSec),mapsec_cmp);
+  *cntp = cnt;
+  return msarray;
+}
+
+
+#define SDMAXSIZE 0x10000       /* reachable by a 16-bit base offset */
+
+static uint64_t sd_symaddr(struct Section *sec,lword offs)
+/* Address of a location in a data section, which is unique among all
+   LinkedSections, even when each of them starts at zero. */
+{
+  return ((uint64_t)sec->lnksec->index << 32) + sec->offset + (uint64_t)offs;
+}
+
+
+static void sd_candidates(struct GlobalVars *gv)
+/* Count the absolute references from code into data, which is not yet
+   accessed base-relative. Each reference is attributed to the data symbol
+   covering the referenced location, or to its section when there is none.
+   List the symbols with the most references per byte, as long as they
+   fit into the small data space. */
+{
+  struct SDCand {
+    struct Section *sec;
+    struct Symbol *sym;         /* NULL: unnamed contents of sec */
+    unsigned long size;
+    unsigned long refs;
+  } *cands,*c;
+  struct SortKey *syms=NULL,*secrefs=NULL,*keys;
+  struct MapSec *msarray,*ms,*msend;
+  struct LinkedSection *ls;
+  struct Section *sec,*dest;
+  struct Symbol *sym;
+  struct Reloc *r;
+  unsigned long nsyms=0,maxsyms=0,nsecrefs=0,maxsecrefs=0,n=0,nrefs=0;
+  unsigned long used=0,avail,totrefs=0,i,j,lo,hi;
+  uint64_t addr;
+  lword offs;
+  int xr;
+
+  /* collect the symbols of all data sections, sorted by address */
+  msarray = sorted_mapsecs(gv,&n);
+  msend = msarray + n;
+  for (ms=msarray; ms<msend; ) {
+    struct ObjectUnit *obj = ms->sec->obj;
+
+    if (obj) {
+      for (i=0; i<OBJSYMHTABSIZE; i++) {
+        for (sym=obj->objsyms[i]; sym; sym=sym->obj_chain) {
+          if (sym->type!=SYM_RELOC || (sec=sym->relsect)==NULL ||
+              sec->obj!=obj || sec->lnksec==NULL ||
+              (sec->type!=ST_DATA && sec->type!=ST_UDATA) ||
+              (sec->lnksec->flags & SF_SMALLDATA) ||
+              sym->value<0 || (unsigned long)sym->value>=sec->size)
+            continue;
+          if (nsyms >= maxsyms) {
+            maxsyms = maxsyms ? maxsyms<<1 : 64;
+            syms = re_alloc(syms,maxsyms*sizeof(struct SortKey));
+          }
+          syms[nsyms].key = sd_symaddr(sec,sym->value);
+          syms[nsyms++].ptr = sym;
+        }
+      }
+    }
+    while (ms<msend && ms->sec->obj==obj)
+      ms++;  /* next object */
+  }
+  free(msarray);
+  if (nsyms)
+    radix_sort(syms,nsyms);
+
+  /* one candidate per symbol, which covers everything up to the next
+     symbol or the end of its section, unless its size is known */
+  cands = alloc((nsyms ? nsyms : 1) * sizeof(struct SDCand));
+  for (i=0; i<nsyms; i++) {
+    sym = (struct Symbol *)syms[i].ptr;
+    cands[i].sec = sym->relsect;
+    cands[i].sym = sym;
+    cands[i].refs = 0;
+    for (j=i+1; j<nsyms && syms[j].key==syms[i].key; j++);
+    if (j<nsyms && ((struct Symbol *)syms[j].ptr)->relsect==sym->relsect)
+      cands[i].size = syms[j].key - syms[i].key;
+    else
+      cands[i].size = sym->relsect->size - (unsigned long)sym->value;
+    if (sym->size!=0 && sym->size<cands[i].size)
+      cands[i].size = sym->size;
+  }
+
+  /* attribute each reference from code to a data symbol or section */
+  for (ls=(struct LinkedSection *)gv->lnksec.first;
+       ls->n.next!=NULL; ls=(struct LinkedSection *)ls->n.next) {
+    for (sec=(struct Section *)ls->sections.first;
+         sec->n.next!=NULL; sec=(struct Section *)sec->n.next) {
+      if (sec->type != ST_CODE)
+        continue;
+      for (xr=0; xr<2; xr++) {
+        for (r=(struct Reloc *)(xr ? sec->xrefs.first : sec->relocs.first);
+             r->n.next!=NULL; r=(struct Reloc *)r->n.next) {
+          if (r->rtype != R_ABS)
+            continue;
+          if (xr) {
+            if ((sym = r->relocsect.symbol) == NULL)
+              continue;
+            dest = sym->relsect;
+            offs = sym->value + r->addend;
+          }
+          else {
+            dest = r->relocsect.ptr;
+            offs = r->addend;
+          }
+          if (dest==NULL || dest->lnksec==NULL || dest->size==0 ||
+              (dest->type!=ST_DATA && dest->type!=ST_UDATA) ||
+              (dest->lnksec->flags & SF_SMALLDATA))
+            continue;
+          nrefs++;
+
+          /* find the last symbol at or below the referenced address */
+          addr = sd_symaddr(dest,offs);
+          for (lo=0,hi=nsyms; lo<hi; ) {
+            i = (lo + hi) / 2;
+            if (syms[i].key <= addr)
+              lo = i + 1;
+            else
+              hi = i;
+          }
+          c = lo ? &cands[lo-1] : NULL;
+          if (c!=NULL && c->sec==dest && offs>=c->sym->value &&
+              offs<c->sym->value+(lword)c->size) {
+            c->refs++;
+          }
+          else {
+            if (nsecrefs >= maxsecrefs) {
+              maxsecrefs = maxsecrefs ? maxsecrefs<<1 : 64;
+              secrefs = re_alloc(secrefs,maxsecrefs*sizeof(struct SortKey));
+            }
+            secrefs[nsecrefs].key = (uint64_t)(uintptr_t)dest;
+            secrefs[nsecrefs++].ptr = dest;
+          }
+        }
+      }
+    }
+  }
+
+  for (ls=(struct LinkedSection *)gv->lnksec.first;
+       ls->n.next!=NULL; ls=(struct LinkedSection *)ls->n.next) {
+    if (ls->flags & SF_SMALLDATA)
+      used += ls->size;
+  }
+  avail = used<SDMAXSIZE ? SDMAXSIZE-used : 0;
+  fprintf(gv->map_file,"\n\nSmall data candidates (numbers in hex):\n"
+          "  %lx of %lx bytes in use\n",used,(unsigned long)SDMAXSIZE);
+  if (nrefs == 0) {
+    fprintf(gv->map_file,"  no absolute references from code to data\n");
+    free(cands);
+    free(syms);
+    return;
+  }
+
+  /* references into unnamed contents are counted per section */
+  n = nsyms;
+  if (nsecrefs) {
+    radix_sort(secrefs,nsecrefs);
+    cands = re_alloc(cands,(nsyms+nsecrefs)*sizeof(struct SDCand));
+    for (i=0; i<nsecrefs; i=j) {
+      for (j=i+1; j<nsecrefs && secrefs[j].ptr==secrefs[i].ptr; j++);
+      cands[n].sec = (struct Section *)secrefs[i].ptr;
+      cands[n].sym = NULL;
+      cands[n].size = cands[n].sec->size;
+      cands[n++].refs = j - i;
+    }
+    free(secrefs);
+  }
+
+  /* order by references per byte */
+  keys = alloc(n * sizeof(struct SortKey));
+  for (i=j=0; i<n; i++) {
+    if (cands[i].refs && cands[i].size) {
+      keys[j].key = ~(((uint64_t)cands[i].refs << 24) / cands[i].size);
+      keys[j++].ptr = &cands[i];
+    }
+  }
+  radix_sort(keys,j);
+
+  for (i=0; i<j; i++) {
+    c = (struct SDCand *)keys[i].ptr;
+    if (c->size <= avail) {
+      avail -= c->size;
+      totrefs += c->refs;
+      fprintf(gv->map_file,"  %8lx refs %8lx bytes  %s  %s(%s)\n",
+              c->refs,c->size,c->sym?c->sym->name:"-",
+              getobjname(c->sec->obj),c->sec->name);
+    }
+  }
+  /* a base-relative offset needs half the size of an absolute address */
+  fprintf(gv->map_file,"  %lx references could be base-relative, "
+          "saving about %lx bytes\n",
+          totrefs,totrefs*(gv->tbytes_per_taddr/2));
+  free(keys);
+  free(cands);
+  free(syms);
+}
+
+
 void linker_mapfile(struct GlobalVars *gv)
 /* print section mapping, when desired */
 {
@@ -1879,6 +3330,11 @@ void linker_mapfile(struct GlobalVars *gv)
     struct ObjectUnit *obj;
     struct Section *sec;
     struct LinkedSection *ls;
+    struct MapSec *msarray,*ms,*msend;
+    unsigned long cnt;
+
+    msarray = sorted_mapsecs(gv,&cnt);
+    msend = msarray + cnt;
 
     /* print file names and the new addresses of their sections */
     fprintf(gv->map_file,"\nFiles:\n");
@@ -1895,17 +3351,14 @@ void linker_mapfile(struct GlobalVars *gv)
           fprintf(gv->map_file,"  %s:",obj->objname);
 
         if (lfile->type != ID_SHAREDOBJ) {
-          for (ls=(struct LinkedSection *)gv->lnksec.first;
-               ls->n.next!=NULL; ls=(struct LinkedSection *)ls->n.next) {
-            for (sec=(struct Section *)ls->sections.first;
-                 sec->n.next!=NULL; sec=(struct Section *)sec->n.next) {
-              if (sec->obj == obj) {  /* section came from this object? */
-                if (!is_common_sec(gv,sec)) {
-                  fprintf(gv->map_file,"%c %s %lx(%lx)",sep,sec->name,
-                          sec->va,sec->size);
-                  sep = ',';
-                }
-              }
+          /* sections which came from this object */
+          for (ms=first_mapsec(msarray,cnt,obj);
+               ms!=NULL && ms<msend && ms->sec->obj==obj; ms++) {
+            sec = ms->sec;
+            if (!is_common_sec(gv,sec)) {
+              fprintf(gv->map_file,"%c %s %lx(%lx)",sep,sec->name,
+                      sec->va,sec->size);
+              sep = ',';
             }
           }
         }
@@ -1916,6 +3369,7 @@ void linker_mapfile(struct GlobalVars *gv)
           fprintf(gv->map_file,"  symbols only\n"); /* empty or shared obj. */
       }
     }
+    free(msarray);
 
     /* print section mappings */
     fprintf(gv->map_file,"\n\nSection mapping (numbers in hex):\n");
@@ -1939,7 +3393,209 @@ void linker_mapfile(struct GlobalVars *gv)
         }
       }
     }
+
+    if (gv->sd_report)
+      sd_candidates(gv);
+  }
+}
+
+
+/* Symbols of the linked input sections, which are collected from the
+   symbol tables of their objects in a single pass by linker_copy(). */
+struct SecSymbols {
+  struct SecSymbols *next;
+  struct Section *sec;
+  struct list symbols;
+};
+
+static struct SecSymbols **secsym_htab;
+static unsigned long secsym_hmask;
+
+
+static struct SecSymbols *find_secsyms(struct Section *sec,bool create)
+{
+  struct SecSymbols **chain,*ss;
+
+  chain = &secsym_htab[((uintptr_t)sec >> 4) & secsym_hmask];
+  for (ss=*chain; ss; ss=ss->next) {
+    if (ss->sec == sec)
+      return ss;
+  }
+  if (create) {
+    ss = alloc(sizeof(struct SecSymbols));
+    ss->next = *chain;
+    ss->sec = sec;
+    initlist(&ss->symbols);
+    *chain = ss;
+  }
+  return ss;
+}
+
+
+static void collect_secsyms(struct GlobalVars *gv)
+/* Assign each object's symbols to the linked sections they are defined
+   in, keeping the order of the object's symbol table. */
+{
+  struct MapSec *msarray,*ms,*msend;
+  struct SecSymbols *ss;
+  struct Symbol *sym;
+  unsigned long cnt,hsize;
+  int i;
+
+  msarray = sorted_mapsecs(gv,&cnt);
+  msend = msarray + cnt;
+  for (hsize=0x100; hsize<cnt; hsize<<=1);
+  secsym_htab = alloc_hashtable(hsize);
+  secsym_hmask = hsize - 1;
+
+  for (ms=msarray; ms<msend; ms++)
+    find_secsyms(ms->sec,TRUE);
+
+  for (ms=msarray; ms<msend; ) {
+    struct ObjectUnit *obj = ms->sec->obj;
+
+    if (obj) {
+      for (i=0; i<OBJSYMHTABSIZE; i++) {
+        for (sym=obj->objsyms[i]; sym; sym=sym->obj_chain) {
+          if (sym->relsect!=NULL && sym->relsect->obj==obj &&
+              (ss = find_secsyms(sym->relsect,FALSE)) != NULL)
+            addtail(&ss->symbols,&sym->n);
+        }
+      }
+    }
+    while (ms<msend && ms->sec->obj==obj)
+      ms++;  /* next object */
+  }
+  free(msarray);
+}
+
+
+static void free_secsyms(void)
+{
+  struct SecSymbols *ss,*next;
+  unsigned long i;
+
+  for (i=0; i<=secsym_hmask; i++) {
+    for (ss=secsym_htab[i]; ss; ss=next) {
+      next = ss->next;
+      free(ss);
+    }
+  }
+  free(secsym_htab);
+  secsym_htab = NULL;
+}
+
+
+static void csv_field(FILE *f,const char *s,bool last)
+/* write a CSV field, quote it when required */
+{
+  if (s!=NULL && strpbrk(s,",\"\r\n")!=NULL) {
+    fputc('"',f);
+    for (; *s; s++) {
+      if (*s == '"')
+        fputc('"',f);
+      fputc(*s,f);
+    }
+    fputc('"',f);
+  }
+  else if (s != NULL)
+    fputs(s,f);
+  fputc(last ? '\n' : ',',f);
+}
+
+
+static void csv_object(FILE *f,struct ObjectUnit *obj)
+/* write file and archive member fields of an object */
+{
+  if (obj==NULL || is_ld_script(obj)) {
+    csv_field(f,NULL,FALSE);
+    csv_field(f,NULL,FALSE);
+  }
+  else if (obj->lnkfile->type == ID_LIBARCH) {
+    csv_field(f,obj->lnkfile->pathname,FALSE);
+    csv_field(f,obj->objname,FALSE);
+  }
+  else {
+    csv_field(f,obj->objname,FALSE);
+    csv_field(f,NULL,FALSE);
+  }
+}
+
+
+static void csvmap_write(struct GlobalVars *gv)
+/* Write a machine-readable link map, with one record per output section,
+   input section, symbol and object file. Addresses and sizes in hex. */
+{
+  FILE *f = gv->csvmap_file;
+  struct LinkedSection *ls;
+  struct Section *sec;
+  struct SortKey *keys;
+  struct Symbol *sym;
+  struct ObjectUnit *obj;
+  struct MapSec *msarray,*ms;
+  unsigned long cnt,secend,pad,i,n;
+
+  fprintf(f,"type,name,section,file,member,"
+            "address,lma,size,padding,alignment\n");
+
+  for (ls=(struct LinkedSection *)gv->lnksec.first;
+       ls->n.next!=NULL; ls=(struct LinkedSection *)ls->n.next) {
+    /* output section with its total alignment padding */
+    for (sec=(struct Section *)ls->sections.first,secend=pad=0;
+         sec->n.next!=NULL; sec=(struct Section *)sec->n.next) {
+      if (sec->offset > secend)
+        pad += sec->offset - secend;
+      secend = sec->offset + sec->size;
+    }
+    fprintf(f,"section,");
+    csv_field(f,ls->name,FALSE);
+    fprintf(f,",,,%lx,%lx,%lx,%lx,%lx\n",ls->base,ls->copybase,
+            ls->size,pad,1UL<<ls->alignment);
+
+    /* contributing input sections */
+    for (sec=(struct Section *)ls->sections.first,secend=0;
+         sec->n.next!=NULL; sec=(struct Section *)sec->n.next) {
+      pad = sec->offset>secend ? sec->offset-secend : 0;
+      secend = sec->offset + sec->size;
+      fprintf(f,"input,");
+      csv_field(f,sec->name,FALSE);
+      csv_field(f,ls->name,FALSE);
+      csv_object(f,sec->obj);
+      fprintf(f,"%lx,%lx,%lx,%lx,%lx\n",sec->va,ls->copybase+sec->offset,
+              sec->size,pad,1UL<<sec->alignment);
+    }
+
+    /* section's symbols, sorted by address */
+    if (keys = sorted_symbols(ls,&n)) {
+      for (i=0; i<n; i++) {
+        sym = keys[i].ptr;
+        fprintf(f,"symbol,");
+        csv_field(f,sym->name,FALSE);
+        csv_field(f,ls->name,FALSE);
+        csv_object(f,sym->relsect!=NULL ? sym->relsect->obj : NULL);
+        fprintf(f,"%llx,,%lx,,\n",(unsigned long long)sym->value,
+                (unsigned long)sym->size);
+      }
+      free(keys);
+    }
+  }
+
+  /* size attribution per object file */
+  msarray = sorted_mapsecs(gv,&cnt);
+  for (obj=(struct ObjectUnit *)gv->selobjects.first;
+       obj->n.next!=NULL; obj=(struct ObjectUnit *)obj->n.next) {
+    unsigned long size = 0;
+
+    if (obj->flags & OUF_SCRIPT)
+      continue;
+    for (ms=first_mapsec(msarray,cnt,obj);
+         ms!=NULL && ms<msarray+cnt && ms->sec->obj==obj; ms++)
+      size += ms->sec->size;
+    fprintf(f,"object,,,");
+    csv_object(f,obj);
+    fprintf(f,",,%lx,,\n",size);
   }
+  free(msarray);
 }
 
 
@@ -1958,6 +3614,8 @@ void linker_copy(struct GlobalVars *gv)
   if (gv->map_file)
     fprintf(gv->map_file,"\n");
 
+  collect_secsyms(gv);
+
   for (ls=(struct LinkedSection *)gv->lnksec.first;
        ls->n.next!=NULL; ls=(struct LinkedSection *)ls->n.next) {
     unsigned long lastsecend = 0;  /* for filling gaps */
@@ -1975,8 +3633,6 @@ void linker_copy(struct GlobalVars *gv)
 
     for (sec=(struct Section *)ls->sections.first;
          sec->n.next!=NULL; sec=(struct Section *)sec->n.next) {
-      int i;
-
       if (ls->data && sec->data) {
         /* copy section contents, fill gaps */
         section_fill(gv,ls->data,lastsecend,sec->filldata,
@@ -1986,24 +3642,22 @@ void linker_copy(struct GlobalVars *gv)
       }
 
       if (sec->obj) {
-        /* find section symbols and fix their offsets */
-        for (i=0; i<OBJSYMHTABSIZE; i++) {
-          for (sym=sec->obj->objsyms[i]; sym; sym=sym->obj_chain) {
-            if (sym->relsect == sec) {
+        /* fix offsets of the section's symbols */
+        struct SecSymbols *ss = find_secsyms(sec,FALSE);
+
+        while (ss!=NULL && (sym=(struct Symbol *)remhead(&ss->symbols))) {
 #if 0
-              if (sym->type==SYM_COMMON &&
-                  (!gv->dest_object || gv->alloc_common)) {
-                /* delete remaining copies of common symbols */
-                remove_obj_symbol(sym);
-              }
+          if (sym->type==SYM_COMMON &&
+              (!gv->dest_object || gv->alloc_common)) {
+            /* delete remaining copies of common symbols */
+            remove_obj_symbol(sym);
+          }
 #endif
-              if (!((sym->flags & (SYMF_REFERENCED|SYMF_PROVIDED))
-                    == SYMF_PROVIDED)) { /* ignore unrefd. provided sym. */
-                if (sym->type == SYM_RELOC)
-                  sym->value += sec->va;  /* was sec->offset */
-                addtail(&ls->symbols,&sym->n);
-              }
-            }
+          if (!((sym->flags & (SYMF_REFERENCED|SYMF_PROVIDED))
+                == SYMF_PROVIDED)) { /* ignore unrefd. provided sym. */
+            if (sym->type == SYM_RELOC)
+              sym->value += sec->va;  /* was sec->offset */
+            addtail(&ls->symbols,&sym->n);
           }
         }
       }
@@ -2011,25 +3665,14 @@ void linker_copy(struct GlobalVars *gv)
 
     if (gv->map_file) {
       /* print section's symbols to map file, sorted by address */
-      struct Symbol **sym_ptr_array,**p;
-      int cnt = 0;
-
-      /* count symbols in this section, then sort them by address */
-      for (sym=(struct Symbol *)ls->symbols.first;
-           sym->n.next!=NULL; sym=(struct Symbol *)sym->n.next)
-        cnt++;
-      if (cnt > 0) {
-        sym_ptr_array = alloc(cnt * sizeof(void *));
-        for (sym=(struct Symbol *)ls->symbols.first,p=sym_ptr_array;
-             sym->n.next!=NULL; sym=(struct Symbol *)sym->n.next)
-          *p++ = sym;
-        if (cnt > 1)
-          qsort(sym_ptr_array,cnt,sizeof(void *),sym_addr_cmp);
+      struct SortKey *keys;
+      unsigned long i,cnt;
 
+      if (keys = sorted_symbols(ls,&cnt)) {
         fprintf(gv->map_file,"\nSymbols of %s:\n",ls->name);
-        for (p=sym_ptr_array; cnt>0; p++,cnt--)
-          print_symbol(gv,gv->map_file,*p);
-        free(sym_ptr_array);
+        for (i=0; i<cnt; i++)
+          print_symbol(gv,gv->map_file,keys[i].ptr);
+        free(keys);
       }
     }
 
@@ -2062,6 +3705,8 @@ void linker_copy(struct GlobalVars *gv)
     }
   }
 
+  free_secsyms();
+
   /* last chance to fix linker symbols */
   fixlnksymbols(gv,maxls);
 
@@ -2070,6 +3715,12 @@ void linker_copy(struct GlobalVars *gv)
        obj->n.next!=NULL; obj=(struct ObjectUnit *)obj->n.next) {
     fixstabs(obj);
   }
+
+  if (gv->csvmap_file) {
+    csvmap_write(gv);
+    fclose(gv->csvmap_file);
+    gv->csvmap_file = NULL;
+  }
 }
 
 
@@ -2116,6 +3767,8 @@ void linker_relocate(struct GlobalVars *gv)
 
             case R_PLTPC:
             case R_GOTPC:
+            case R_GOTPCX:
+            case R_GOTPCXREX:
               if (gv->dest_object)
                 break;
               rel->rtype = R_PC;
@@ -2261,6 +3914,7 @@ void linker_relocate(struct GlobalVars *gv)
               break;
             
             case R_ABS:
+            case R_LOADREL:     /* relative to load address (dynamic) */
             case R_NONE:
               break;
 
@@ -2330,6 +3984,8 @@ void linker_relocate(struct GlobalVars *gv)
 
                   case R_PLTPC:
                   case R_GOTPC:
+                  case R_GOTPCX:
+                  case R_GOTPCXREX:
                     /* PC-relative PLT/GOT reference */
                     if (gv->dest_object)
                       break;
@@ -2519,15 +4175,41 @@ void linker_relocate(struct GlobalVars *gv)
 }
 
 
+static void write_splitdebug(struct GlobalVars *gv)
+/* Read back the complete output image from the debug file and let the
+   target write it without debugging information into the output file. */
+{
+  uint8_t *img;
+  FILE *f;
+
+  if ((img = (uint8_t *)mapfile(gv->debug_name)) == NULL) {
+    error(8,gv->debug_name);  /* Cannot open */
+    return;
+  }
+  if ((f = fopen(gv->dest_name,"wb")) == NULL) {
+    error(29,gv->dest_name);  /* Can't create output file */
+    return;
+  }
+  if (gv->trace_file)
+    fprintf(gv->trace_file,"Stripping debug information into %s.\n",
+            gv->dest_name);
+  fff[gv->dest_format]->splitdebug(gv,f,img,
+                                   *(size_t *)(img-sizeof(size_t)));
+  fclose(f);
+}
+
+
 void linker_write(struct GlobalVars *gv)
 {
+  /* with split debug information the complete image goes to debug_name */
+  const char *name = gv->debug_name ? gv->debug_name : gv->dest_name;
   FILE *f;
 
   if (!gv->errflag) {  /* no error? */
     if (gv->trace_file) {
       if (!gv->output_sections)
         fprintf(gv->trace_file,"\nCreating output file %s (%s).\n",
-                gv->dest_name,fff[gv->dest_format]->tname);
+                name,fff[gv->dest_format]->tname);
       else
         fprintf(gv->trace_file,"\nCreating output files for each "
                                "section (%s).\n",
@@ -2536,8 +4218,8 @@ void linker_write(struct GlobalVars *gv)
 
     /* create output file */
     if (!gv->output_sections && !(fff[gv->dest_format]->flags&FFF_NOFILE)) {
-      if ((f = fopen(gv->dest_name,"wb")) == NULL) {
-        error(29,gv->dest_name);  /* Can't create output file */
+      if ((f = fopen(name,"wb")) == NULL) {
+        error(29,name);  /* Can't create output file */
         return;
       }
     }
@@ -2559,6 +4241,8 @@ void linker_write(struct GlobalVars *gv)
 
     if (f != NULL) {
       fclose(f);
+      if (gv->debug_name && !gv->errflag)
+        write_splitdebug(gv);
       if (!gv->dest_sharedobj && !gv->dest_object)
         set_exec(gv->dest_name);  /* set executable flag */
     }
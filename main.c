@@ -7,6 +7,7 @@
 
 
 #define MAIN_C
+#include <time.h>
 #include "vlink.h"
 
 struct GlobalVars gvars;
@@ -66,6 +67,26 @@ lword get_assign_arg(int argc,const char *argv[],int *i,char *name,size_t len)
 }
 
 
+static void phase_time(struct GlobalVars *gv,const char *name)
+/* print the processor time spent in the link phase which just ended,
+   or the time spent in all phases, when name is "total" */
+{
+  static clock_t start,last;
+  clock_t now = clock();
+
+  if (name == NULL)
+    start = now;
+  else if (gv->phase_times) {
+    if (!strcmp(name,"total"))
+      last = start;
+    fprintf(stderr,"%-16s %9.3fs\n",name,(double)(now-last)/CLOCKS_PER_SEC);
+  }
+  last = now;
+}
+
+#define PHASE(f) (f(gv),phase_time(gv,#f))
+
+
 static void ReadListFile(struct GlobalVars *gv,const char *name,uint16_t flags)
 /* read a file, which contains a list of object file names */
 {
@@ -191,6 +212,7 @@ int main(int argc,const char *argv[])
   initlist(&gv->lnksec);
   gv->dest_name = "a.out";
   gv->maxerrors = DEF_MAXERRORS;
+  gv->cache_limit = DEF_CACHELIMIT;
   gv->reloctab_format = RTAB_UNDEF;
   gv->osec_base_name = NULL;
 
@@ -248,6 +270,20 @@ int main(int argc,const char *argv[])
         case 'c':
           if (!strncmp(&argv[i][2],"lr-",3))
             flags &= ~(chk_flags(argv[i]));   /* -clr-flags */
+          else if (!strcmp(&argv[i][2],"ache"))
+            gv->cache_dir = get_arg(argc,argv,&i);
+          else if (!strcmp(&argv[i][2],"achesize")) {
+            long sz;
+
+            if (sscanf(get_arg(argc,argv,&i),"%li",&sz) == 1)
+              gv->cache_limit = (unsigned long)sz;
+          }
+          else if (!strcmp(&argv[i][2],"allgraph"))
+            gv->callgraph_order = TRUE;
+          else if (!strcmp(&argv[i][2],"ombreloc")) {
+            if (gv->dynreloc_format < DYNREL_SORTED)
+              gv->dynreloc_format = DYNREL_SORTED;
+          }
           else goto unknown;
           break;
 
@@ -256,6 +292,8 @@ int main(int argc,const char *argv[])
             gv->alloc_common = TRUE;  /* force alloc. of common syms. */
           else if (argv[i][2] == 'a')
             gv->alloc_addr = TRUE;  /* force alloc. of address syms. */
+          else if (!strcmp(&argv[i][2],"ebugfile"))
+            gv->debug_name = get_arg(argc,argv,&i);
           else goto unknown;
           break;
 
@@ -303,6 +341,8 @@ int main(int argc,const char *argv[])
             show_usage();      /* help text */
             exit(EXIT_SUCCESS);
           }
+          else if (!strcmp(&argv[i][2],"ugepages"))
+            gv->huge_pages = TRUE;
           else goto unknown;
           break;
 
@@ -351,6 +391,11 @@ int main(int argc,const char *argv[])
             gv->merge_all = TRUE;
           else if (!strcmp(&argv[i][2],"ultibase"))
             gv->multibase = TRUE;
+          else if (!strcmp(&argv[i][2],"apcsv") &&
+                   (buf = get_arg(argc,argv,&i)) != NULL) {
+            if ((gv->csvmap_file = fopen(buf,"w")) == NULL)
+              error(29,buf);
+          }
           else goto unknown;
           break;
 
@@ -381,6 +426,12 @@ int main(int argc,const char *argv[])
           else goto unknown;
           break;
 
+        case 'p':
+          if (!strcmp(&argv[i][2],"ack"))  /* -pack sections by alignment */
+            gv->pack_sections = TRUE;
+          else goto unknown;
+          break;
+
         case 'q':  /* force relocations into final executable */
           if (argv[i][2]) goto unknown;
           gv->keep_relocs = TRUE;
@@ -397,6 +448,8 @@ int main(int argc,const char *argv[])
               addtail(&gv->rpaths,&libp->n);
             }
           }
+          else if (!strcmp(&argv[i][2],"elr"))  /* -relr */
+            gv->dynreloc_format = DYNREL_RELR;
           else goto unknown;
           break;
 
@@ -409,18 +462,29 @@ int main(int argc,const char *argv[])
             gv->small_code = TRUE;
           else if (!strcmp(&argv[i][2],"d"))       /* -sd force small data */
             gv->small_data = TRUE;
+          else if (!strcmp(&argv[i][2],"drefs"))   /* -sdrefs */
+            gv->sd_report = TRUE;
           else if (!strcmp(&argv[i][2],"hared"))   /* -shared */
             gv->dest_sharedobj = TRUE;
           else if (!strcmp(&argv[i][2],"oname"))   /* -soname <real name> */
             gv->soname = get_arg(argc,argv,&i);
           else if (!strcmp(&argv[i][2],"tatic"))   /* -static */
             gv->dynamic = FALSE;
+          else if (!strcmp(&argv[i][2],"ymorder")) {  /* -symorder <file> */
+            buf = get_arg(argc,argv,&i);
+            if (gv->symorder = mapfile(buf))
+              gv->symorder_name = buf;
+            else
+              error(8,buf);
+          }
           else goto unknown;
           break;
 
         case 't':  /* trace file accesses */
           if (!strcmp(&argv[i][2],"extbaserel"))
             gv->textbaserel = TRUE;
+          else if (!strcmp(&argv[i][2],"ime"))     /* -time */
+            gv->phase_times = TRUE;
           else if (!argv[i][2])
             gv->trace_file = stderr;
           else goto unknown;
@@ -567,6 +631,10 @@ int main(int argc,const char *argv[])
         case 'M':  /* mapping output */
           if (!argv[i][2] || (gv->map_file = fopen(&argv[i][2],"w"))==NULL)
             gv->map_file = stdout;
+          else {
+            gv->map_name = &argv[i][2];
+            setvbuf(gv->map_file,NULL,_IOFBF,MAPBUFSIZE);
+          }
           break;
 
         case 'N':  /* rename input sections */
@@ -672,19 +740,24 @@ int main(int argc,const char *argv[])
   }
 
   /* link them... */
-  linker_init(gv);
-  linker_load(gv);     /* load all objects and libraries and their symbols */
-  linker_resolve(gv);  /* resolve symbol references */
-  linker_relrefs(gv);  /* find all relative references between sections */
-  linker_dynprep(gv);  /* prepare for dynamic linking */
-  linker_sectrefs(gv); /* find all referenced sections from the start */
-  linker_gcsects(gv);  /* section garbage collection (gc_sects) */
-  linker_join(gv);     /* join sections with same name and type */
-  linker_mapfile(gv);  /* mapfile output */
-  linker_copy(gv);     /* copy section contents and fix symbol offsets */
-  linker_delunused(gv);/* delete empty/unused sects. without relocs/symbols */
-  linker_relocate(gv); /* relocate addresses in joined sections */
-  linker_write(gv);    /* write output file in selected target format */
+  phase_time(gv,NULL);
+  PHASE(linker_init);
+  PHASE(linker_load);     /* load all objects and libraries and their symbols */
+  if (!cache_fetch(gv,argc,argv)) {  /* output not found in link cache */
+    PHASE(linker_resolve);  /* resolve symbol references */
+    PHASE(linker_relrefs);  /* find all relative references between sections */
+    PHASE(linker_dynprep);  /* prepare for dynamic linking */
+    PHASE(linker_sectrefs); /* find all referenced sections from the start */
+    PHASE(linker_gcsects);  /* section garbage collection (gc_sects) */
+    PHASE(linker_join);     /* join sections with same name and type */
+    PHASE(linker_mapfile);  /* mapfile output */
+    PHASE(linker_copy);     /* copy section contents and fix symbol offsets */
+    PHASE(linker_delunused);/* delete empty/unused sects. w/o relocs/symbols */
+    PHASE(linker_relocate); /* relocate addresses in joined sections */
+    PHASE(linker_write);    /* write output file in selected target format */
+    cache_store(gv);        /* remember output file in link cache */
+  }
+  phase_time(gv,"total");
   linker_cleanup(gv);
 
   cleanup(gv);
@@ -6,9 +6,20 @@
  */
 
 
+#if !defined(AMIGAOS) && !defined(ATARI) && !defined(_WIN32)
+#define MAPFILE_MMAP  /* map large files with mmap() on UNIX */
+#define _DEFAULT_SOURCE
+#endif
+
 #define SUPPORT_C
 #include "vlink.h"
 
+#ifdef MAPFILE_MMAP
+#include <sys/mman.h>
+#include <unistd.h>
+#define MMAPMINSIZE 0x10000  /* smaller files are read */
+#endif
+
 #define GAPBUFSIZE 1024  /* for fwritegap() */
 
 const char *endian_name[2] = { "little", "big" };
@@ -179,6 +190,32 @@ static size_t filesize(FILE *fp,const char *name)
 }
 
 
+#ifdef MAPFILE_MMAP
+static char *mmapfile(FILE *fp,size_t fsiz)
+/* Map a file with mmap(), so only the parts which are really accessed,
+   like the used members of large archives, are read from disk.
+   The first page is reserved for the file size, and at least one
+   zero-byte follows the file contents. Returns NULL on failure. */
+{
+  size_t pgsize = (size_t)sysconf(_SC_PAGESIZE);
+  size_t len = pgsize + ((fsiz+pgsize) & ~(pgsize-1));
+  char *base,*p;
+
+  base = mmap(NULL,len,PROT_READ|PROT_WRITE,MAP_PRIVATE|MAP_ANON,-1,0);
+  if (base == MAP_FAILED)
+    return NULL;
+  p = base + pgsize;
+  if (mmap(p,fsiz,PROT_READ|PROT_WRITE,MAP_PRIVATE|MAP_FIXED,
+           fileno(fp),0) == MAP_FAILED) {
+    munmap(base,len);
+    return NULL;
+  }
+  *(size_t *)(p-sizeof(size_t)) = fsiz;
+  return p;
+}
+#endif
+
+
 char *mapfile(const char *name)
 /* Map a complete file into memory and return its address. */
 /* The file's length is returned in *(p-sizeof(size_t)). */
@@ -191,6 +228,12 @@ char *mapfile(const char *name)
 
   if (fp = fopen(name,"rb")) {
     fsiz = filesize(fp,name);
+#ifdef MAPFILE_MMAP
+    if (fsiz >= MMAPMINSIZE && (p = mmapfile(fp,fsiz)) != NULL) {
+      fclose(fp);
+      return p;
+    }
+#endif
     p = alloc(fsiz+sizeof(size_t)+1);
     *(size_t *)p = fsiz;  /* store file size before the text starts */
     p += sizeof(size_t);
@@ -834,6 +877,55 @@ int highest_bit_set(lword x)
 }
 
 
+void radix_sort(struct SortKey *a,unsigned long n)
+/* Stable sort by key in linear time. LSD radix sort with 8-bit digits,
+   skipping digits which are identical in all keys. */
+{
+  struct SortKey *tmp,*src,*dst,*t,k;
+  unsigned long cnt[256],i,j,sum,c;
+  uint64_t diff = 0;
+  int shift;
+
+  if (n < RADIXMIN) {
+    for (i=1; i<n; i++) {
+      k = a[i];
+      for (j=i; j>0 && a[j-1].key>k.key; j--)
+        a[j] = a[j-1];
+      a[j] = k;
+    }
+    return;
+  }
+
+  for (i=1; i<n; i++)
+    diff |= a[i].key ^ a[0].key;
+  tmp = alloc(n*sizeof(struct SortKey));
+  src = a;
+  dst = tmp;
+
+  for (shift=0; shift<64 && (diff>>shift)!=0; shift+=8) {
+    if (((diff>>shift) & 0xff) == 0)
+      continue;  /* all keys have the same digit */
+    memset(cnt,0,sizeof(cnt));
+    for (i=0; i<n; i++)
+      cnt[(src[i].key>>shift) & 0xff]++;
+    for (i=0,sum=0; i<256; i++) {
+      c = cnt[i];
+      cnt[i] = sum;
+      sum += c;
+    }
+    for (i=0; i<n; i++)
+      dst[cnt[(src[i].key>>shift) & 0xff]++] = src[i];
+    t = src;
+    src = dst;
+    dst = t;
+  }
+
+  if (src != a)
+    memcpy(a,src,n*sizeof(struct SortKey));
+  free(tmp);
+}
+
+
 lword sign_extend(lword v,int n)
 /* sign-extend an n-bit value to lword-size */
 {
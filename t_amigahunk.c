@@ -37,6 +37,7 @@ static void ados_writeobject(struct GlobalVars *,FILE *);
 static void ehf_writeobject(struct GlobalVars *,FILE *);
 static void writeshared(struct GlobalVars *,FILE *);
 static void writeexec(struct GlobalVars *,FILE *);
+static void splitdebug(struct GlobalVars *,FILE *,uint8_t *,unsigned long);
 
 struct FFFuncs fff_amigahunk = {
   "amigahunk",
@@ -64,7 +65,9 @@ struct FFFuncs fff_amigahunk = {
   RTAB_STANDARD,RTAB_STANDARD|RTAB_SHORTOFF,
   _BIG_ENDIAN_,
   32,1,
-  FFF_RELOCATABLE
+  FFF_RELOCATABLE|FFF_ID_HUNK,
+  NULL,
+  splitdebug
 };
 
 struct FFFuncs fff_ehf = {
@@ -93,7 +96,9 @@ struct FFFuncs fff_ehf = {
   RTAB_STANDARD,RTAB_STANDARD|RTAB_SHORTOFF,
   _BIG_ENDIAN_,
   32,2,
-  FFF_RELOCATABLE
+  FFF_RELOCATABLE|FFF_ID_HUNK,
+  NULL,
+  splitdebug
 };
 
 /* Automagically create symbols in .tocd, which start with the */
@@ -130,6 +135,190 @@ static bool exthunk,symhunk,resmode,broken_debug;
 static struct list *rlist,rrlist;
 static int *rcnt,rrcnt;
 
+/* Overlay tree. Node 0 is the root. Input files following a -hunkoverlay
+   option belong to that node, which is stored in ObjectUnit.extra. */
+struct OvlNode {
+  struct node *mark;            /* last input file before this node */
+  int level;                    /* 0 returns to the root */
+  int parent;
+  int ordinate;                 /* counts the children of a parent */
+  int first,last;               /* hunk numbers in the executable */
+};
+static struct OvlNode *ovlnodes;
+static int novlnodes,maxovlnodes,ovlmaxlevel;
+#define MAXOVLNODES 0x100
+
+/* overlay references, which are called through a stub in the root */
+struct OvlRef {
+  struct Section *sec;          /* destination section and offset */
+  lword offset;
+  int node;
+};
+static struct OvlRef *ovlrefs;
+static int novlrefs,maxovlrefs;
+static const char ovlymgr_name[] = "_ovlyMgr";
+#define OVLSTUBSIZE 8           /* JSR _ovlyMgr, DC.W index */
+
+
+
+static void add_ovlnode(struct GlobalVars *gv,const char *arg)
+/* -hunkoverlay <level>: the following input files form a new overlay node,
+   which is a child of the most recent node on the next lower level */
+{
+  struct OvlNode *on;
+  long level;
+  int p,i;
+
+  if (sscanf(arg,"%li",&level)!=1 || level<0)
+    error(157,arg);  /* illegal overlay level */
+  if (novlnodes == 0) {
+    maxovlnodes = 16;
+    ovlnodes = alloczero(maxovlnodes*sizeof(struct OvlNode));
+    ovlnodes[0].parent = -1;
+    novlnodes = 1;
+  }
+  else if (novlnodes >= maxovlnodes) {
+    if (novlnodes >= MAXOVLNODES)
+      error(158,MAXOVLNODES);  /* too many overlay nodes */
+    maxovlnodes <<= 1;
+    ovlnodes = re_alloc(ovlnodes,maxovlnodes*sizeof(struct OvlNode));
+  }
+
+  /* level 0 nodes only return to the root and are never a parent */
+  for (p=novlnodes-1;
+       p>0 && (ovlnodes[p].level>=level || ovlnodes[p].level==0); p--);
+  if (level>0 && ovlnodes[p].level!=level-1)
+    error(157,arg);  /* no parent node on the next lower level */
+
+  on = &ovlnodes[novlnodes];
+  on->mark = gv->inputlist.last;
+  on->level = (int)level;
+  on->parent = level ? p : -1;
+  on->ordinate = 1;
+  on->first = on->last = -1;
+  for (i=1; i<novlnodes; i++) {
+    if (ovlnodes[i].level && ovlnodes[i].parent==p)
+      on->ordinate++;
+  }
+  if (on->level > ovlmaxlevel)
+    ovlmaxlevel = on->level;
+  novlnodes++;
+}
+
+
+static bool ovl_descendant(int node,int ancestor)
+{
+  while (node > 0) {
+    if ((node = ovlnodes[node].parent) == ancestor)
+      return TRUE;
+  }
+  return FALSE;
+}
+
+
+static void ovl_stubs(struct GlobalVars *gv)
+/* Assign all selected object units to their overlay node. Then redirect
+   references into an overlay node, which is not loaded together with
+   the referencing node, to a stub in the root, calling the overlay
+   manager. */
+{
+  struct InputFile *ifn;
+  struct ObjectUnit *obj;
+  struct Section *sec,*stubsec=NULL;
+  struct Reloc *xref,*nextxref,*r;
+  int i,node;
+
+  for (ifn=(struct InputFile *)gv->inputlist.first,i=1,node=0;
+       ifn->n.next!=NULL; ifn=(struct InputFile *)ifn->n.next) {
+    while (i<novlnodes && ovlnodes[i].mark==ifn->n.pred) {
+      node = ovlnodes[i].level ? i : 0;
+      i++;
+    }
+    if (node && !ifn->lib) {
+      for (obj=(struct ObjectUnit *)gv->selobjects.first;
+           obj->n.next!=NULL; obj=(struct ObjectUnit *)obj->n.next) {
+        if (!strcmp(obj->lnkfile->pathname,ifn->name))
+          obj->extra = (uint8_t)node;
+      }
+    }
+  }
+
+  for (obj=(struct ObjectUnit *)gv->selobjects.first;
+       obj->n.next!=NULL; obj=(struct ObjectUnit *)obj->n.next) {
+    for (sec=(struct Section *)obj->sections.first;
+         sec->n.next!=NULL; sec=(struct Section *)sec->n.next) {
+      xref = (struct Reloc *)sec->xrefs.first;
+
+      while (nextxref = (struct Reloc *)xref->n.next) {
+        struct Symbol *xdef = xref->relocsect.symbol;
+
+        if (xdef!=NULL && xdef->type==SYM_RELOC &&
+            (node = xdef->relsect->obj->extra)!=0 && node!=obj->extra &&
+            !ovl_descendant(obj->extra,node)) {
+          lword offset = xdef->value + xref->addend;
+
+          if (xdef->relsect->type!=ST_CODE ||
+              !ovl_descendant(node,obj->extra)) {
+            /* data, or a node which is not loaded by the overlay manager */
+            error(156,getobjname(obj),sec->name,xref->offset,
+                  xref->xrefname,node);
+            xref = nextxref;
+            continue;
+          }
+
+          for (i=0; i<novlrefs; i++) {
+            if (ovlrefs[i].sec==xdef->relsect && ovlrefs[i].offset==offset)
+              break;
+          }
+          if (i == novlrefs) {
+            /* new overlay reference */
+            if (novlrefs >= maxovlrefs) {
+              maxovlrefs = maxovlrefs ? maxovlrefs<<1 : 64;
+              ovlrefs = re_alloc(ovlrefs,maxovlrefs*sizeof(struct OvlRef));
+            }
+            if (stubsec == NULL) {
+              struct ObjectUnit *ou = art_objunit(gv,"OVERLAY",NULL,0);
+
+              stubsec = add_section(ou,"OVLYSTUBS",NULL,0,ST_CODE,
+                                    SF_ALLOC,SP_READ|SP_EXEC,1,FALSE);
+            }
+            ovlrefs[i].sec = xdef->relsect;
+            ovlrefs[i].offset = offset;
+            ovlrefs[i].node = node;
+            novlrefs++;
+            /* dummy reference, to keep the destination section */
+            r = newreloc(gv,stubsec,NULL,xdef->relsect,0,i*OVLSTUBSIZE,
+                         R_NONE,0);
+            addreloc(stubsec,r,0,0,-1);
+          }
+
+          /* redirect the reference to the stub */
+          xref->xrefname = NULL;
+          xref->relocsect.ptr = stubsec;
+          xref->addend = i * OVLSTUBSIZE;
+          remnode(&xref->n);
+          addtail(&sec->relocs,&xref->n);
+        }
+        xref = nextxref;
+      }
+    }
+  }
+
+  if (stubsec) {
+    /* JSR _ovlyMgr, DC.W index */
+    stubsec->size = novlrefs * OVLSTUBSIZE;
+    stubsec->data = alloczero(stubsec->size);
+    for (i=0; i<novlrefs; i++) {
+      write16be(stubsec->data+i*OVLSTUBSIZE,0x4eb9);
+      write16be(stubsec->data+i*OVLSTUBSIZE+6,(uint16_t)i);
+      r = newreloc(gv,stubsec,ovlymgr_name,NULL,0,i*OVLSTUBSIZE+2,R_ABS,0);
+      addreloc(stubsec,r,0,32,-1);
+    }
+    /* enqueue artificial object unit into linking process */
+    stubsec->obj->lnkfile->type = ID_OBJECT;
+    add_objunit(gv,stubsec->obj,FALSE);
+  }
+}
 
 
 static void init(struct GlobalVars *gv,int mode)
@@ -138,6 +327,8 @@ static void init(struct GlobalVars *gv,int mode)
     merged_hash = elf_hash(merged_name);
     nomerge_hash = elf_hash(nomerge_name);
   }
+  else if (mode==FFINI_RESOLVE && novlnodes>1 && !gv->dest_object)
+    ovl_stubs(gv);
 }
 
 
@@ -154,6 +345,8 @@ static int options(struct GlobalVars *gv,int argc,const char **argv,int *i)
   }
   else if (!strcmp(argv[*i],"-broken-debug"))
     broken_debug = TRUE;
+  else if (!strcmp(argv[*i],"-hunkoverlay"))
+    add_ovlnode(gv,get_arg(argc,argv,i));
   else
     return 0;
   return 1;
@@ -1079,7 +1272,9 @@ static void readconv(struct GlobalVars *gv,struct LinkFile *lf)
 
       case HUNK_OVERLAY:
       case HUNK_BREAK:
-        ierror("readconv(): HUNK_OVERLAY/BREAK not yet supported");
+        /* overlaid executable: only the root node is read */
+        error(159,lf->pathname);
+        hi.hunkcnt = 0;
         break;
 
       case HUNK_END:
@@ -1183,6 +1378,9 @@ static uint8_t cmpsecflags(struct LinkedSection *ls,struct Section *sec)
 {
   if (ls->flags&SF_EHFPPC != sec->flags&SF_EHFPPC)
     return 0xff;
+  if (novlnodes>1 && !listempty(&ls->sections) &&
+      ((struct Section *)ls->sections.first)->obj->extra != sec->obj->extra)
+    return 0xff;  /* never join sections from different overlay nodes */
   if (!ls->memattr || !sec->memattr || ls->memattr==sec->memattr)
     return ls->flags | sec->flags;
   return 0xff;
@@ -1687,6 +1885,8 @@ static void unsupp_relocs(struct GlobalVars *gv,struct LinkedSection *sec)
   struct Reloc *rel;
 
   while (rel = (struct Reloc *)remhead(&sec->relocs)) {
+    if (rel->rtype == R_NONE)
+      continue;
     error(32,fff_amigahunk.tname,reloc_name[rel->rtype],
           (int)rel->insert->bpos,(int)rel->insert->bsiz,
           mtaddr(gv,rel->insert->mask),sec->name,rel->offset);
@@ -2114,12 +2314,221 @@ static void ehf_writeobject(struct GlobalVars *gv,FILE *f)
 }
 
 
+static int hunk_sizes(FILE *f,struct LinkedSection *ls,int n,
+                      struct LinkedSection *resls)
+/* write section size specifiers for up to n sections, starting with ls */
+{
+  struct LinkedSection *nextls;
+  int i = 0;
+
+  while (i<n && (nextls = (struct LinkedSection *)ls->n.next)) {
+    uint32_t len;
+
+    /* resident mode smalldata section has special reloc table appended */
+    if (ls == resls)
+      len = ((ls->filesize + 3) >> 2) + rrcnt + 1;
+    else
+      len = (ls->size + 3) >> 2;
+    hunk_memdata(f,ls->memattr,len);
+    ls = nextls;
+    i++;
+  }
+  return i;
+}
+
+
+static void exec_hunk(struct GlobalVars *gv,FILE *f,struct LinkedSection *ls,
+                      struct LinkedSection *resls)
+/* write a section with its relocations and symbols as executable hunk */
+{
+  int i;
+
+  exthunk = symhunk = FALSE;
+
+  switch (ls->type) {  /* section type */
+    case ST_CODE:
+      fwrite32be(f,HUNK_CODE);
+      break;
+    case ST_DATA:
+      fwrite32be(f,HUNK_DATA);
+      break;
+    case ST_UDATA:
+      fwrite32be(f,ls==resls?HUNK_DATA:HUNK_BSS);
+      break;
+    default:
+      ierror("writeexec(): Illegal section type %u",ls->type);
+      break;
+  }
+
+  fix_reloc_addends(gv,ls);
+
+  /* Work around a bug in AmigaOS LoadSeg() (up to dos.library V40), which
+     gets confused with completely uninitialized data-bss sections. */
+  if (!(ls->flags&SF_UNINITIALIZED) && ls->filesize==0)
+    ls->filesize = ls->size>4 ? 4 : ls->size;
+
+  if (ls == resls) {
+    struct Reloc *rel;
+
+    fwrite32be(f,((ls->filesize+3)>>2)+rrcnt+1);
+    fwritex(f,ls->data,ls->filesize);   /* write section contents */
+    fwrite_align(gv,f,2,ls->filesize);
+
+    /* Append a special reloc table for resident programs.
+       Format: ulong nentries [, ulong reloc-offset ...] */
+    fwrite32be(f,rrcnt);
+    for (i=0,rel=(struct Reloc *)rrlist.first;
+         rel->n.next!=NULL; rel=(struct Reloc *)rel->n.next,i++)
+      fwrite32be(f,rel->offset);
+
+    if (i != rrcnt)
+      ierror("writeexec(): Res.Relocs found: %d expected: %d\n",i,rrcnt);
+  }
+  else if (ls->flags & SF_UNINITIALIZED) {
+    fwrite32be(f,(ls->size+3)>>2);  /* bss - size only */
+  }
+  else {
+    fwrite32be(f,(ls->filesize+3)>>2);  /* initialized section size */
+    fwritex(f,ls->data,ls->filesize);   /* write section contents */
+    fwrite_align(gv,f,2,ls->filesize);
+  }
+
+  /* relocation hunks */
+  if (gv->reloctab_format==RTAB_SHORTOFF)
+    reloc_hunk(gv,f,ls,HUNK_DREL32,R_ABS,32);  /* HUNK_RELOC32SHORT */
+  reloc_hunk(gv,f,ls,HUNK_ABSRELOC32,R_ABS,32);
+  reloc_hunk(gv,f,ls,HUNK_RELRELOC32,R_PC,32);
+  unsupp_relocs(gv,ls);  /* print unsupported relocations */
+
+  /* symbol table */
+  ext_defs(gv,f,ls,SYMB_GLOBAL,SYM_RELOC,EXT_SYMB);
+  ext_defs(gv,f,ls,SYMB_GLOBAL,SYM_ABS,EXT_IGNORE);
+  ext_defs(gv,f,ls,SYMB_GLOBAL,SYM_INDIR,EXT_IGNORE);
+  ext_defs(gv,f,ls,SYMB_LOCAL,SYM_RELOC,EXT_SYMB);
+  ext_defs(gv,f,ls,SYMB_LOCAL,SYM_ABS,EXT_IGNORE);
+  ext_defs(gv,f,ls,SYMB_LOCAL,SYM_INDIR,EXT_IGNORE);
+  ext_defs(gv,f,ls,SYMB_WEAK,SYM_RELOC,EXT_IGNORE);
+  ext_defs(gv,f,ls,SYMB_WEAK,SYM_ABS,EXT_IGNORE);
+  ext_defs(gv,f,ls,SYMB_WEAK,SYM_INDIR,EXT_IGNORE);
+  if (symhunk)
+    fwrite32be(f,0);  /* close HUNK_SYMBOL block, if required */
+  unsupp_symbols(ls);  /* print unsupported symbol definitions */
+
+  /* line debug hunks */
+  if (gv->strip_symbols < STRIP_DEBUG) {
+    if (checktargetext(ls,TGEXT_AMIGAOS,SUBID_LINE))
+      linedebug_hunks(gv,f,ls);
+  }
+
+  fwrite32be(f,HUNK_END);  /* end of this section */
+}
+
+
+static int ovl_node(struct LinkedSection *ls)
+{
+  if (listempty(&ls->sections))
+    return 0;
+  return ((struct Section *)ls->sections.first)->obj->extra;
+}
+
+
+static int ovl_sections(struct GlobalVars *gv)
+/* Sort the sections by overlay nodes, starting with the root, and
+   assign the hunk numbers. Returns the number of root hunks. */
+{
+  struct LinkedSection *ls,*nextls;
+  struct list sorted;
+  int i,n;
+
+  initlist(&sorted);
+  for (i=0,n=0; i<novlnodes; i++) {
+    ovlnodes[i].first = n;
+    ls = (struct LinkedSection *)gv->lnksec.first;
+    while (nextls = (struct LinkedSection *)ls->n.next) {
+      if (ovl_node(ls) == i) {
+        remnode(&ls->n);
+        addtail(&sorted,&ls->n);
+        ls->index = n++;
+      }
+      ls = nextls;
+    }
+    ovlnodes[i].last = n - 1;
+  }
+  if (!listempty(&gv->lnksec))
+    ierror("writeexec(): sections without overlay node");
+  while (ls = (struct LinkedSection *)remhead(&sorted))
+    addtail(&gv->lnksec,&ls->n);
+
+  return ovlnodes[0].last + 1;
+}
+
+
+static void ovl_write(struct GlobalVars *gv,FILE *f,
+                      struct LinkedSection *ls,struct LinkedSection *resls)
+/* Write the overlay table and all overlay nodes. Each node is loaded
+   on demand by the overlay manager, from the file offset of its
+   HUNK_HEADER, until HUNK_BREAK. */
+{
+  long tabpos,*seekpos;
+  struct OvlRef *or;
+  int i,j;
+
+  fwrite32be(f,HUNK_OVERLAY);
+  fwrite32be(f,ovlmaxlevel+1+novlrefs*8);  /* table size - 1 */
+  fwrite32be(f,ovlmaxlevel+2);
+  for (i=0; i<=ovlmaxlevel; i++)
+    fwrite32be(f,0);
+  tabpos = ftell(f);
+  for (i=0; i<novlrefs*8; i++)
+    fwrite32be(f,0);  /* overlay symbol table is written later */
+
+  seekpos = alloczero(novlnodes*sizeof(long));
+  for (i=1; i<novlnodes; i++) {
+    struct OvlNode *on = &ovlnodes[i];
+
+    if (on->last < on->first)
+      continue;  /* empty node, or return to the root */
+    seekpos[i] = ftell(f);
+    fwrite32be(f,HUNK_HEADER);
+    fwrite32be(f,0);
+    fwrite32be(f,gv->nsecs);
+    fwrite32be(f,on->first);
+    fwrite32be(f,on->last);
+    if (hunk_sizes(f,ls,on->last-on->first+1,resls) != on->last-on->first+1)
+      ierror("writeexec(): overlay node %d is incomplete",i);
+    for (j=on->first; j<=on->last; j++) {
+      exec_hunk(gv,f,ls,resls);
+      ls = (struct LinkedSection *)ls->n.next;
+    }
+    fwrite32be(f,HUNK_BREAK);
+  }
+
+  /* overlay symbol table: seek offset, 0, 0, level, ordinate,
+     first hunk, symbol hunk, symbol offset (+4 for the segment pointer) */
+  fseek(f,tabpos,SEEK_SET);
+  for (i=0,or=ovlrefs; i<novlrefs; i++,or++) {
+    struct OvlNode *on = &ovlnodes[or->node];
+
+    fwrite32be(f,seekpos[or->node]);
+    fwrite32be(f,0);
+    fwrite32be(f,0);
+    fwrite32be(f,on->level);
+    fwrite32be(f,on->ordinate);
+    fwrite32be(f,on->first);
+    fwrite32be(f,or->sec->lnksec->index);
+    fwrite32be(f,or->sec->offset+or->offset+4);
+  }
+  fseek(f,0,SEEK_END);
+  free(seekpos);
+}
+
+
 static void writeexec(struct GlobalVars *gv,FILE *f)
 /* creates a target-amigahunk executable file (which is relocatable) */
 {
   struct LinkedSection *ls = (struct LinkedSection *)gv->lnksec.first;
-  struct LinkedSection *nextls,*resls;
-  int i=0;
+  struct LinkedSection *resls;
+  int i,nroot;
 
   alloc_reloc_lists(gv);
 
@@ -2145,109 +2554,142 @@ static void writeexec(struct GlobalVars *gv,FILE *f)
     return;
   }
 
-  fwrite32be(f,gv->nsecs);  /* number of sections - no overlay support! @@@ */
+  if (novlnodes > 1) {
+    nroot = ovl_sections(gv);  /* root hunks first, then overlay nodes */
+    ls = (struct LinkedSection *)gv->lnksec.first;
+  }
+  else
+    nroot = gv->nsecs;
+
+  fwrite32be(f,gv->nsecs);  /* number of sections */
   fwrite32be(f,0);
-  fwrite32be(f,gv->nsecs-1);
+  fwrite32be(f,nroot-1);
 
   /* write section size specifiers */
-  while (nextls = (struct LinkedSection *)ls->n.next) {
-    uint32_t len;
-
-    /* resident mode smalldata section has special reloc table appended */
-    if (ls == resls)
-      len = ((ls->filesize + 3) >> 2) + rrcnt + 1;
-    else
-      len = (ls->size + 3) >> 2;
-    hunk_memdata(f,ls->memattr,len);
-    ls = nextls;
-    i++;
-  }
-  if (i != gv->nsecs)
+  if ((i = hunk_sizes(f,ls,nroot,resls)) != nroot)
     ierror("writeexec(): %d sections in list, but it should be %d",
-           i,gv->nsecs);
+           i,nroot);
 
   /* section loop */
-  ls = (struct LinkedSection *)gv->lnksec.first;
-  while (nextls = (struct LinkedSection *)ls->n.next) {
-    exthunk = symhunk = FALSE;
-
-    switch (ls->type) {  /* section type */
-      case ST_CODE:
-        fwrite32be(f,HUNK_CODE);
-        break;
-      case ST_DATA:
-        fwrite32be(f,HUNK_DATA);
-        break;
-      case ST_UDATA:
-        fwrite32be(f,ls==resls?HUNK_DATA:HUNK_BSS);
-        break;
-      default:
-        ierror("writeexec(): Illegal section type %u",ls->type);
-        break;
-    }
+  for (i=0; i<nroot; i++) {
+    exec_hunk(gv,f,ls,resls);
+    ls = (struct LinkedSection *)ls->n.next;
+  }
 
-    fix_reloc_addends(gv,ls);
+  if (novlnodes > 1)
+    ovl_write(gv,f,ls,resls);
+}
 
-    /* Work around a bug in AmigaOS LoadSeg() (up to dos.library V40), which
-       gets confused with completely uninitialized data-bss sections. */
-    if (!(ls->flags&SF_UNINITIALIZED) && ls->filesize==0)
-      ls->filesize = ls->size>4 ? 4 : ls->size;
 
-    if (ls == resls) {
-      struct Reloc *rel;
 
-      fwrite32be(f,((ls->filesize+3)>>2)+rrcnt+1);
-      fwritex(f,ls->data,ls->filesize);   /* write section contents */
-      fwrite_align(gv,f,2,ls->filesize);
+static void splitdebug(struct GlobalVars *gv,FILE *f,uint8_t *img,
+                       unsigned long len)
+/* copy the executable, which was already written completely into the
+   debug file, without HUNK_SYMBOL and HUNK_DEBUG blocks */
+{
+  static const char *fn = "splitdebug(): ";
+  uint8_t *p=img,*end=img+len,*start,*ovltab=NULL;
+  uint32_t type,first,last,n;
+  unsigned long outpos,ovlpos=0;
+  long *nodepos = NULL;
+  int nnodes=0;
+
+  if (len<20 || read32be(p)!=HUNK_HEADER || read32be(p+4)!=0)
+    ierror("%sno hunk executable",fn);
+  first = read32be(p+12);
+  last = read32be(p+16);
+  p += 20;
+  while (first++ <= last) {  /* section size specifiers */
+    if ((read32be(p) & HUNKF_MEMTYPE) == HUNKF_MEMTYPE)
+      p += 4;  /* extension word with memory attributes */
+    p += 4;
+  }
+  fwritex(f,img,p-img);
+  outpos = p - img;
 
-      /* Append a special reloc table for resident programs.
-         Format: ulong nentries [, ulong reloc-offset ...] */
-      fwrite32be(f,rrcnt);
-      for (i=0,rel=(struct Reloc *)rrlist.first;
-           rel->n.next!=NULL; rel=(struct Reloc *)rel->n.next,i++)
-        fwrite32be(f,rel->offset);
+  while (p < end) {
+    start = p;
+    type = read32be(p) & ~HUNKF_MEMTYPE;
+    p += 4;
 
-      if (i != rrcnt)
-        ierror("writeexec(): Res.Relocs found: %d expected: %d\n",i,rrcnt);
-    }
-    else if (ls->flags & SF_UNINITIALIZED) {
-      fwrite32be(f,(ls->size+3)>>2);  /* bss - size only */
+    switch (type) {
+      case HUNK_OVERLAY:
+        ovltab = start;
+        ovlpos = outpos;
+        nodepos = alloc(2*novlnodes*sizeof(long));
+        p += 8 + (read32be(p) << 2);
+        break;
+      case HUNK_HEADER:
+        /* overlay node: remember old and new file offset */
+        if (ovltab==NULL || nnodes>=novlnodes)
+          ierror("%sunexpected overlay node",fn);
+        nodepos[2*nnodes] = start - img;
+        nodepos[2*nnodes+1] = outpos;
+        nnodes++;
+        first = read32be(p+8);
+        last = read32be(p+12);
+        p += 16;
+        while (first++ <= last) {
+          if ((read32be(p) & HUNKF_MEMTYPE) == HUNKF_MEMTYPE)
+            p += 4;
+          p += 4;
+        }
+        break;
+      case HUNK_CODE:
+      case HUNK_DATA:
+      case HUNK_DEBUG:
+        p += 4 + ((read32be(p) & ~HUNKF_MEMTYPE) << 2);
+        break;
+      case HUNK_BSS:
+        p += 4;
+        break;
+      case HUNK_RELOC32:
+      case HUNK_SYMBOL:
+        while ((n = read32be(p)) != 0)
+          p += 8 + (n << 2);  /* relocs or symbol name, plus value */
+        p += 4;
+        break;
+      case HUNK_DREL32:
+      case HUNK_RELOC32SHORT:
+      case HUNK_RELRELOC32:
+        /* 16-bit offsets in executables, terminated with 32-bit alignment */
+        while ((n = read16be(p)) != 0)
+          p += 4 + (n << 1);
+        p += 2;
+        if ((p - img) & 2)
+          p += 2;
+        break;
+      case HUNK_END:
+      case HUNK_BREAK:
+        break;
+      default:
+        ierror("%sunexpected hunk type %lu",fn,(unsigned long)type);
+        break;
     }
-    else {
-      fwrite32be(f,(ls->filesize+3)>>2);  /* initialized section size */
-      fwritex(f,ls->data,ls->filesize);   /* write section contents */
-      fwrite_align(gv,f,2,ls->filesize);
+    if (p > end)
+      ierror("%shunk executable is truncated",fn);
+    if (type!=HUNK_SYMBOL && type!=HUNK_DEBUG) {
+      fwritex(f,start,p-start);
+      outpos += p - start;
     }
+  }
 
-    /* relocation hunks */
-    if (gv->reloctab_format==RTAB_SHORTOFF)
-      reloc_hunk(gv,f,ls,HUNK_DREL32,R_ABS,32);  /* HUNK_RELOC32SHORT */
-    reloc_hunk(gv,f,ls,HUNK_ABSRELOC32,R_ABS,32);
-    reloc_hunk(gv,f,ls,HUNK_RELRELOC32,R_PC,32);
-    unsupp_relocs(gv,ls);  /* print unsupported relocations */
-
-    /* symbol table */
-    ext_defs(gv,f,ls,SYMB_GLOBAL,SYM_RELOC,EXT_SYMB);
-    ext_defs(gv,f,ls,SYMB_GLOBAL,SYM_ABS,EXT_IGNORE);
-    ext_defs(gv,f,ls,SYMB_GLOBAL,SYM_INDIR,EXT_IGNORE);
-    ext_defs(gv,f,ls,SYMB_LOCAL,SYM_RELOC,EXT_SYMB);
-    ext_defs(gv,f,ls,SYMB_LOCAL,SYM_ABS,EXT_IGNORE);
-    ext_defs(gv,f,ls,SYMB_LOCAL,SYM_INDIR,EXT_IGNORE);
-    ext_defs(gv,f,ls,SYMB_WEAK,SYM_RELOC,EXT_IGNORE);
-    ext_defs(gv,f,ls,SYMB_WEAK,SYM_ABS,EXT_IGNORE);
-    ext_defs(gv,f,ls,SYMB_WEAK,SYM_INDIR,EXT_IGNORE);
-    if (symhunk)
-      fwrite32be(f,0);  /* close HUNK_SYMBOL block, if required */
-    unsupp_symbols(ls);  /* print unsupported symbol definitions */
+  if (ovltab) {
+    /* fix seek offsets in the overlay symbol table */
+    uint8_t *tab = ovltab + 8 + (read32be(ovltab+8) << 2);
+    int i;
 
-    /* line debug hunks */
-    if (gv->strip_symbols < STRIP_DEBUG) {
-      if (checktargetext(ls,TGEXT_AMIGAOS,SUBID_LINE))
-        linedebug_hunks(gv,f,ls);
+    for (n=(read32be(ovltab+4)+1-read32be(ovltab+8))>>3; n; n--,tab+=32) {
+      for (i=0; i<nnodes; i++) {
+        if (read32be(tab) == (uint32_t)nodepos[2*i]) {
+          fseek(f,ovlpos+(tab-ovltab),SEEK_SET);
+          fwrite32be(f,nodepos[2*i+1]);
+          break;
+        }
+      }
     }
-
-    fwrite32be(f,HUNK_END);  /* end of this section */
-    ls = nextls;
+    fseek(f,0,SEEK_END);
+    free(nodepos);
   }
 }
 
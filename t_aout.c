@@ -779,14 +779,39 @@ static int aout_sectindex(struct LinkedSection **sections,
 }
 
 
+static void aout_growsymlist(uint32_t newsize)
+/* Resize the node and symbol arrays to newsize entries and rebuild the
+   hash table with newsize buckets, which must be a power of two. */
+{
+  struct SymbolNode *sn,**chain;
+  uint32_t i;
+
+  aoutsymlist.htabsize = newsize;
+  aoutsymlist.nodes = re_alloc(aoutsymlist.nodes,
+                               newsize*sizeof(struct SymbolNode));
+  aoutsymlist.syms = re_alloc(aoutsymlist.syms,
+                              newsize*sizeof(struct nlist32));
+  free(aoutsymlist.hashtab);
+  aoutsymlist.hashtab = alloczero(newsize*sizeof(struct SymbolNode *));
+
+  for (i=0,sn=aoutsymlist.nodes; i<aoutsymlist.nextindex; i++,sn++) {
+    chain = &aoutsymlist.hashtab[elf_hash(sn->name) & (newsize-1)];
+    sn->hashchain = *chain;
+    *chain = sn;
+  }
+}
+
+
 void aout_initwrite(struct GlobalVars *gv,struct LinkedSection **sections)
 {
   initlist(&aoutstrlist.l);
   aoutstrlist.hashtab = alloczero(STRHTABSIZE*sizeof(struct StrTabNode *));
   aoutstrlist.nextoffset = 4;  /* first string is always at offset 4 */
-  initlist(&aoutsymlist.l);
-  aoutsymlist.hashtab = alloczero(SYMHTABSIZE*sizeof(struct SymbolNode *));
+  aoutsymlist.nodes = NULL;
+  aoutsymlist.syms = NULL;
+  aoutsymlist.hashtab = NULL;
   aoutsymlist.nextindex = 0;
+  aout_growsymlist(SYMTABINITSIZE);
   initlist(&treloclist);
   initlist(&dreloclist);
 
@@ -873,25 +898,29 @@ static uint32_t aout_addsym(const char *name,uint32_t value,uint8_t bind,
 {
   struct SymbolNode **chain;
   struct SymbolNode *sym;
+  struct nlist32 *s;
 
   if (name == NULL)
     name = noname;
-
-  chain = &aoutsymlist.hashtab[elf_hash(name)%SYMHTABSIZE];
-  while (sym = *chain)
-    chain = &sym->hashchain;
-  /* new symbol table entry */
-  *chain = sym = alloczero(sizeof(struct SymbolNode));
-
+  if (aoutsymlist.nextindex >= aoutsymlist.htabsize)
+    aout_growsymlist(aoutsymlist.htabsize<<1);
+
+  /* new symbol table entry, inserted at the head of its hash chain */
+  chain = &aoutsymlist.hashtab[elf_hash(name)&(aoutsymlist.htabsize-1)];
+  sym = &aoutsymlist.nodes[aoutsymlist.nextindex];
+  sym->hashchain = *chain;
+  *chain = sym;
   sym->name = name;
   sym->index = aoutsymlist.nextindex++;
-  write32(be,&sym->s.n_strx,aout_addstr(name));
-  sym->s.n_type = type;
+
+  s = &aoutsymlist.syms[sym->index];
+  memset(s,0,sizeof(struct nlist32));
+  write32(be,&s->n_strx,aout_addstr(name));
+  s->n_type = type;
   /* @@@ GNU binutils don't use BIND_LOCAL/GLOBAL in a.out files! We do! */
-  sym->s.n_other = ((bind&0xf)<<4) | (info&0xf);
-  write16(be,&sym->s.n_desc,desc);
-  write32(be,&sym->s.n_value,value);
-  addtail(&aoutsymlist.l,&sym->n);
+  s->n_other = ((bind&0xf)<<4) | (info&0xf);
+  write16(be,&s->n_desc,desc);
+  write32(be,&s->n_value,value);
   return (sym->index);
 }
 
@@ -1012,18 +1041,19 @@ void aout_debugsyms(struct GlobalVars *gv,bool be)
 }
 
 
-static int aout_findsym(const char *name,bool be)
-/* find a symbol by its name, return symbol table index or -1 */
+int aout_findsym(const char *name,bool be)
+/* find the first symbol with this name, return symbol table index or -1 */
 {
-  struct SymbolNode **chain = &aoutsymlist.hashtab[elf_hash(name)%SYMHTABSIZE];
   struct SymbolNode *sym;
+  int idx = -1;
 
-  while (sym = *chain) {
+  /* chains start with the newest symbol, so take the last match */
+  for (sym=aoutsymlist.hashtab[elf_hash(name)&(aoutsymlist.htabsize-1)];
+       sym; sym=sym->hashchain) {
     if (!strcmp(name,sym->name))
-      return ((int)sym->index);
-    chain = &sym->hashchain;
+      idx = (int)sym->index;
   }
-  return (-1);
+  return (idx);
 }
 
 
@@ -1235,10 +1265,7 @@ void aout_writerelocs(FILE *f,struct list *l)
 
 void aout_writesymbols(FILE *f)
 {
-  struct SymbolNode *sym;
-
-  while (sym = (struct SymbolNode *)remhead(&aoutsymlist.l))
-    fwritex(f,&sym->s,sizeof(struct nlist32));
+  fwritex(f,aoutsymlist.syms,aoutsymlist.nextindex*sizeof(struct nlist32));
 }
 
 
@@ -82,7 +82,7 @@ struct FFFuncs fff_aoutbsdi386 = {
   RTAB_STANDARD,RTAB_STANDARD,
   _LITTLE_ENDIAN_,
   32,0,
-  FFF_BASEINCR
+  FFF_BASEINCR|FFF_ID_AOUT
 };
 #endif
 
@@ -116,7 +116,7 @@ struct FFFuncs fff_aoutpc386 = {
   RTAB_STANDARD,RTAB_STANDARD,
   _LITTLE_ENDIAN_,
   32,0,
-  FFF_BASEINCR
+  FFF_BASEINCR|FFF_ID_AOUT
 };
 #endif
 
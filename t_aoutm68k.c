@@ -122,7 +122,7 @@ struct FFFuncs fff_aoutbsd68k = {
   RTAB_STANDARD,RTAB_STANDARD,
   _BIG_ENDIAN_,
   32,1,
-  FFF_BASEINCR
+  FFF_BASEINCR|FFF_ID_AOUT
 };
 #endif
 
@@ -156,7 +156,7 @@ struct FFFuncs fff_aoutbsd68k4k = {
   RTAB_STANDARD,RTAB_STANDARD,
   _BIG_ENDIAN_,
   32,1,
-  FFF_BASEINCR
+  FFF_BASEINCR|FFF_ID_AOUT
 };
 #endif
 
@@ -190,7 +190,7 @@ struct FFFuncs fff_aoutsun010 = {
   RTAB_STANDARD,RTAB_STANDARD,
   _BIG_ENDIAN_,
   32,1,
-  FFF_BASEINCR
+  FFF_BASEINCR|FFF_ID_AOUT
 };
 #endif
 
@@ -224,7 +224,7 @@ struct FFFuncs fff_aoutsun020 = {
   RTAB_STANDARD,RTAB_STANDARD,
   _BIG_ENDIAN_,
   32,2,
-  FFF_BASEINCR
+  FFF_BASEINCR|FFF_ID_AOUT
 };
 #endif
 
@@ -288,7 +288,7 @@ struct FFFuncs fff_aoutjaguar = {
   RTAB_STANDARD,RTAB_STANDARD,
   _BIG_ENDIAN_,
   32,1,
-  FFF_BASEINCR|AOUT_JAGRELOC
+  FFF_BASEINCR|AOUT_JAGRELOC|FFF_ID_AOUT
 };
 #endif
 
@@ -84,15 +84,9 @@ struct FFFuncs fff_aoutmint = {
 static struct nlist32 *find_aout_sym(const char *name)
 /* returns pointer to aout symbol table entry */
 {
-  struct SymbolNode **chain = &aoutsymlist.hashtab[elf_hash(name)%SYMHTABSIZE];
-  struct SymbolNode *sym;
+  int idx = aout_findsym(name,TRUE);
 
-  while (sym = *chain) {
-    if (!strcmp(name,sym->name))
-      return &sym->s;
-    chain = &sym->hashchain;
-  }
-  return NULL;
+  return idx>=0 ? &aoutsymlist.syms[idx] : NULL;
 }
 
 
@@ -78,7 +78,7 @@ struct FFFuncs fff_aoutnull = {
   RTAB_STANDARD,RTAB_STANDARD,
   -1,    /* endianness unknown */
   32,0,  /* @@@ standard a.out is always based on 32 bit addresses */
-  FFF_BASEINCR
+  FFF_BASEINCR|FFF_ID_AOUT
 };
 
 
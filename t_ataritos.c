@@ -20,6 +20,7 @@ static unsigned long headersize(struct GlobalVars *);
 static void writeobject(struct GlobalVars *,FILE *);
 static void writeshared(struct GlobalVars *,FILE *);
 static void writeexec(struct GlobalVars *,FILE *);
+static void splitdebug(struct GlobalVars *,FILE *,uint8_t *,unsigned long);
 
 
 struct FFFuncs fff_ataritos = {
@@ -48,7 +49,9 @@ struct FFFuncs fff_ataritos = {
   RTAB_STANDARD,RTAB_STANDARD,
   _BIG_ENDIAN_,
   32,1,
-  FFF_BASEINCR
+  FFF_BASEINCR,
+  NULL,
+  splitdebug
 };
 
 
@@ -359,4 +362,28 @@ static void writeexec(struct GlobalVars *gv,FILE *f)
 }
 
 
+
+static void splitdebug(struct GlobalVars *gv,FILE *f,uint8_t *img,
+                       unsigned long len)
+/* copy the executable, which was already written completely into the
+   debug file, without its symbol table */
+{
+  PH hdr;
+  unsigned long tdlen,slen;
+
+  if (len < sizeof(PH))
+    ierror("splitdebug(): no TOS executable");
+  memcpy(&hdr,img,sizeof(PH));
+  tdlen = read32be(hdr.ph_tlen) + read32be(hdr.ph_dlen);
+  slen = read32be(hdr.ph_slen);
+  if (sizeof(PH)+tdlen+slen > len)
+    ierror("splitdebug(): TOS executable is truncated");
+
+  write32be(hdr.ph_slen,0);
+  fwritex(f,&hdr,sizeof(PH));
+  fwritex(f,img+sizeof(PH),tdlen);
+  fwritex(f,img+sizeof(PH)+tdlen+slen,len-(sizeof(PH)+tdlen+slen));
+}
+
+
 #endif
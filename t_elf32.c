@@ -686,8 +686,7 @@ static void elf32_makehash(struct GlobalVars *gv)
     hdata = (uint32_t *)hashsec->data;
     write32(be,&hdata[0],nbuckets);
     write32(be,&hdata[1],nsyms);
-    for (sn=(struct SymbolNode *)elfdsymlist.l.first;
-         sn->n.next!=NULL; sn=(struct SymbolNode *)sn->n.next) {
+    for (sn=elfdsymlist.nodes; sn<elfdsymlist.nodes+nsyms; sn++) {
       uint32_t *i = &hdata[2 + elf_hash(sn->name) % nbuckets];
       uint32_t j;
 
@@ -771,6 +770,17 @@ void elf32_dyncreate(struct GlobalVars *gv,const char *pltgot_name)
       elf32_dynamicentry(gv,DT_RELSZ,elfdynrelocs->size,NULL);
       elf32_dynamicentry(gv,DT_RELENT,sizeof(struct Elf32_Rel),NULL);
     }
+    /* number of leading relative relocations, when sorted */
+    if (gv->dynreloc_format!=DYNREL_UNSORTED && elfrelcount>0)
+      elf32_dynamicentry(gv,gv->reloctab_format==RTAB_ADDEND?
+                         DT_RELACOUNT:DT_RELCOUNT,elfrelcount,NULL);
+  }
+  /* do we have packed relative relocations? */
+  if (elfrelrrelocs) {
+    elf_relrsize(gv);
+    elf32_dynamicentry(gv,DT_RELR,0,elfrelrrelocs);
+    elf32_dynamicentry(gv,DT_RELRSZ,elfrelrrelocs->size,NULL);
+    elf32_dynamicentry(gv,DT_RELRENT,sizeof(uint32_t),NULL);
   }
   /* end tag */
   elf32_dynamicentry(gv,DT_NULL,0,NULL);
@@ -947,6 +957,10 @@ static void elf32_sec2shdr(struct LinkedSection *ls,bool bss,uint64_t f)
 
   if (!strncmp(ls->name,note_name,strlen(note_name)))
     type = SHT_NOTE;
+  else if (!strcmp(ls->name,relr_name)) {
+    type = SHT_RELR;
+    entsize = sizeof(uint32_t);
+  }
   else if (!strncmp(ls->name,".rela",5)) {
     type = SHT_RELA;
     entsize = sizeof(struct Elf32_Rela);
@@ -1094,6 +1108,7 @@ static size_t elf32_putdynreloc(struct GlobalVars *gv,struct LinkedSection *ls,
 {
   const char *fn = "elf32_putdynreloc()";
   struct Elf32_Rela *rp = (struct Elf32_Rela *)dst;
+  lword a = rel->addend;
   uint32_t symidx;
   uint8_t rtype;
 
@@ -1105,6 +1120,11 @@ static size_t elf32_putdynreloc(struct GlobalVars *gv,struct LinkedSection *ls,
       ierror("%s no symbol <%s> in dyn.table",fn,rel->xrefname);
     symidx = sn->index;
   }
+  else if (rel->rtype == R_LOADREL) {
+    /* relative to load address, the addend is the link address */
+    symidx = 0;
+    a += (lword)rel->relocsect.lnk->base;
+  }
   else
     ierror("%s no symbol base",fn);
 
@@ -1123,11 +1143,11 @@ static size_t elf32_putdynreloc(struct GlobalVars *gv,struct LinkedSection *ls,
   write32(be,rp->r_info,ELF32_R_INFO(symidx,(uint32_t)rtype));
 
   if (rela) {
-    write32(be,rp->r_addend,(uint32_t)rel->addend);
+    write32(be,rp->r_addend,(uint32_t)a);
     writesection(gv,ls->data,rel->offset,rel,0);
     return sizeof(struct Elf32_Rela);
   }
-  writesection(gv,ls->data,rel->offset,rel,rel->addend);
+  writesection(gv,ls->data,rel->offset,rel,a);
   return sizeof(struct Elf32_Rel);
 }
 
@@ -1140,6 +1160,8 @@ static void elf32_makedynamic(struct GlobalVars *gv,
     bool be = elf_endianness == _BIG_ENDIAN_;
     int rela = gv->reloctab_format==RTAB_ADDEND ? 1 : 0;
     struct LinkedSection *ls;
+    struct DynRelocRef *drr;
+    unsigned long i,n;
     uint8_t *dynp,*pltp;
 
     if (ls = find_lnksec(gv,dynrel_name[rela],0,0,0,0))
@@ -1152,20 +1174,24 @@ static void elf32_makedynamic(struct GlobalVars *gv,
       pltp = NULL;
 
     /* write dynamic relocations */
+    elf_putrelr(gv);
+    drr = elf_dynrelocs(gv,&n);
+    for (i=0; i<n; i++) {
+      if (dynp == NULL)
+        ierror("%s %s lost",fn,dynrel_name[rela]);
+      dynp += elf32_putdynreloc(gv,drr[i].ls,drr[i].rel,dynp,
+                                reloc_vlink2elf,rela,be);
+    }
+    free(drr);
+
+    /* write PLT relocations */
     for (ls=(struct LinkedSection *)gv->lnksec.first;
          ls->n.next!=NULL; ls=(struct LinkedSection *)ls->n.next) {
       struct Reloc *rel = (struct Reloc *)ls->xrefs.first;
       struct Reloc *nextrel;
 
       while (nextrel = (struct Reloc *)rel->n.next) {
-        if (rel->flags & RELF_DYN) {
-          if (dynp == NULL)
-            ierror("%s %s lost",fn,dynrel_name[rela]);
-          dynp += elf32_putdynreloc(gv,ls,rel,dynp,reloc_vlink2elf,rela,be);
-          remnode(&rel->n);
-          /* free rel */
-        }
-        else if (rel->flags & RELF_PLT) {
+        if (rel->flags & RELF_PLT) {
           if (pltp == NULL)
             ierror("%s %s lost",fn,pltrel_name[rela]);
           pltp += elf32_putdynreloc(gv,ls,rel,pltp,reloc_vlink2elf,rela,be);
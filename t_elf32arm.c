@@ -17,6 +17,8 @@
 static int armle_identify(struct GlobalVars *,char *,uint8_t *,unsigned long,bool);
 static void armle_readconv(struct GlobalVars *,struct LinkFile *);
 static void armle_dyncreate(struct GlobalVars *);
+static bool armle_farcall(struct GlobalVars *,struct Section *,
+                          struct Reloc *);
 static void armle_writeobject(struct GlobalVars *,FILE *);
 static void armle_writeshared(struct GlobalVars *,FILE *);
 static void armle_writeexec(struct GlobalVars *,FILE *);
@@ -48,7 +50,10 @@ struct FFFuncs fff_elf32armle = {
   0,
   RTAB_STANDARD,RTAB_STANDARD|RTAB_ADDEND,
   _LITTLE_ENDIAN_,
-  32,2
+  32,2,
+  FFF_ID_ELF,
+  armle_farcall,
+  elf_splitdebug
 };
 
 
@@ -75,20 +80,20 @@ static uint8_t armle_reloc_elf2vlink(uint8_t rtype,struct RelocInsert *ri)
   /* Reloc conversion table for V.4-ABI - @@@ INCOMPLETE!!! */
   static struct ELF2vlink convertV4[] = {
     R_NONE,0,0,-1,
-    R_PC,8,24,0x3fffffc,        /* PC24, deprecated! Use CALL or JUMP24! */
+    R_PC,0,24,0x3fffffc,        /* PC24, deprecated! Use CALL or JUMP24! */
     R_ABS,0,32,-1,              /* ABS32 */
     R_PC,0,32,-1,               /* REL32 */
-    R_PC,20,12,0x1fff,          /* LDR_PC_G0 */
+    R_PC,0,12,0x1fff,           /* LDR_PC_G0 */
     R_ABS,0,16,-1,              /* ABS16 */
-    R_ABS,20,12,0xfff,          /* ABS12 */
-    R_ABS,5,5,0x1f,             /* THM_ABS5 */
+    R_ABS,0,12,0xfff,           /* ABS12 */
+    R_ABS,6,5,0x1f,             /* THM_ABS5 */
     R_ABS,0,8,-1,               /* ABS8 */
     R_SD,0,32,-1,               /* SBREL32 */
-    R_PC,5,11,0,                /* THM_CALL, needs 2nd ri */
-    R_PC,8,8,0x3fc,             /* THM_PC8 */
+    R_PC,0,11,0,                /* THM_CALL, needs 2nd ri */
+    R_PC,0,8,0x3fc,             /* THM_PC8 */
     R_NONE,0,0,-1,
-    R_ABS,8,24,0xffffff,        /* SWI24, obsolete! */
-    R_ABS,8,8,0xff,             /* THM_SWI8, obsolete! */
+    R_ABS,0,24,0xffffff,        /* SWI24, obsolete! */
+    R_ABS,0,8,0xff,             /* THM_SWI8, obsolete! */
     R_NONE,0,0,-1,
     R_NONE,0,0,-1,
     R_NONE,0,0,-1,
@@ -102,13 +107,13 @@ static uint8_t armle_reloc_elf2vlink(uint8_t rtype,struct RelocInsert *ri)
     R_NONE,0,0,-1,
     R_NONE,0,0,-1,
     R_NONE,0,0,-1,
-    R_PC,8,24,0x3fffffc,        /* CALL, PC24 for uncond. bl/blx only */
-    R_PC,8,24,0x3fffffc,        /* JUMP24, PC24 for other branches */
+    R_PC,0,24,0x3fffffc,        /* CALL, PC24 for uncond. bl/blx only */
+    R_PC,0,24,0x3fffffc,        /* JUMP24, PC24 for other branches */
     R_NONE,0,0,-1,
     R_NONE,0,0,-1,
-    R_PC,24,8,0xff,             /* ALU_PCREL_7_0, obsolete! */
-    R_PC,24,8,0xff00,           /* ALU_PCREL_15_8, obsolete! */
-    R_PC,24,8,0xff0000,         /* ALU_PCREL_23_15, obsolete! */
+    R_PC,0,8,0xff,              /* ALU_PCREL_7_0, obsolete! */
+    R_PC,0,8,0xff00,            /* ALU_PCREL_15_8, obsolete! */
+    R_PC,0,8,0xff0000,          /* ALU_PCREL_23_15, obsolete! */
     R_NONE,0,0,-1,
     R_NONE,0,0,-1,
     R_NONE,0,0,-1,
@@ -128,7 +133,7 @@ static uint8_t armle_reloc_elf2vlink(uint8_t rtype,struct RelocInsert *ri)
         /* a 23-bit branch consisting of two THUMB instruction */
         ri->mask = 0x7ff000;
         ri2.mask = 0xffe;
-        ri2.bpos = 16+5;
+        ri2.bpos = 16;
         ri2.bsiz = 11;
       }
       else {
@@ -174,6 +179,29 @@ static void armle_dyncreate(struct GlobalVars *gv)
 }
 
 
+static bool armle_farcall(struct GlobalVars *gv,struct Section *stub,
+                          struct Reloc *r)
+/* Make a veneer for an out-of-range 24-bit B/BL, which loads the
+   destination address from a literal into the PC. */
+{
+  struct RelocInsert *ri = r->insert;
+
+  if (ri==NULL || ri->next!=NULL ||
+      ri->bpos!=0 || ri->bsiz!=24 || ri->mask!=0x3fffffc)
+    return FALSE;  /* not an ARM CALL/JUMP24 branch */
+
+  stub->size = 8;
+  stub->data = alloc(stub->size);
+  write32le(stub->data,0xe51ff004);  /* ldr pc,[pc,#-4] */
+  write32le(stub->data+4,0);         /* .word dest */
+
+  /* the branch addend includes the PC offset of 8 */
+  addreloc(stub,stubreloc(r,4,r->addend+8),0,32,-1);
+  r->addend = -8;
+  return TRUE;
+}
+
+
 
 /*****************************************************************/
 /*                          Write ELF                            */
@@ -200,33 +228,33 @@ static uint8_t armle_reloc_vlink2elf(struct Reloc *r)
             case 8: return R_ARM_ABS8;
           }
         }
-        else if (size==24 && (pos&31)==8 && mask==0xffffff && !ri2)
+        else if (size==24 && (pos&31)==0 && mask==0xffffff && !ri2)
           return R_ARM_SWI24; /* @@@ obsolete */
-        else if (size==12 && (pos&31)==20 && mask==0xfff && !ri2)
+        else if (size==12 && (pos&31)==0 && mask==0xfff && !ri2)
           return R_ARM_ABS12;
-        else if (size==8 && (pos&15)==8 && mask==0xff && !ri2)
+        else if (size==8 && (pos&15)==0 && mask==0xff && !ri2)
           return R_ARM_THM_SWI8; /* @@@ obsolete */
-        else if (size==5 && (pos&15)==5 && mask==0x1f && !ri2)
+        else if (size==5 && (pos&15)==6 && mask==0x1f && !ri2)
           return R_ARM_THM_ABS5;
         break;
 
       case R_PC:
         if (size==32 && !(pos&7) && mask==-1 && !ri2)
           return R_ARM_REL32;
-        else if (size==24 && (pos&31)==8 && mask==0x3fffffc && !ri2)
+        else if (size==24 && (pos&31)==0 && mask==0x3fffffc && !ri2)
           return R_ARM_PC24;  /* @@@ deprecated: use R_ARM_CALL/JUMP24!!! */
-        else if (size==12 && (pos&31)==20 && mask==0x1fff && !ri2)
+        else if (size==12 && (pos&31)==0 && mask==0x1fff && !ri2)
           return R_ARM_LDR_PC_G0;
-        else if (size==8 && (pos&31)==24 && mask==0xff && !ri2)
+        else if (size==8 && (pos&31)==0 && mask==0xff && !ri2)
           return R_ARM_ALU_PCREL_7_0;  /* @@@ obsolete */
-        else if (size==8 && (pos&31)==24 && mask==0xff00 && !ri2)
+        else if (size==8 && (pos&31)==0 && mask==0xff00 && !ri2)
           return R_ARM_ALU_PCREL_15_8;  /* @@@ obsolete */
-        else if (size==8 && (pos&31)==24 && mask==0xff0000 && !ri2)
+        else if (size==8 && (pos&31)==0 && mask==0xff0000 && !ri2)
           return R_ARM_ALU_PCREL_23_15;  /* @@@ obsolete */
-        else if (size==8 && (pos&15)==8 && mask==0x3fc && !ri2)
+        else if (size==8 && (pos&15)==0 && mask==0x3fc && !ri2)
           return R_ARM_THM_PC8;
-        else if (size==11 && (pos&15)==5 && ri2) {
-          if (ri2->bsiz==11 && (ri2->bpos&15)==5) {
+        else if (size==11 && (pos&15)==0 && ri2) {
+          if (ri2->bsiz==11 && (ri2->bpos&15)==0) {
             if ((mask==0x7ff000 && ri2->mask==0xffe) ||
                 (mask==0xffe && ri2->mask==0x7ff000))
               return R_ARM_THM_CALL;
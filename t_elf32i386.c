@@ -52,7 +52,10 @@ struct FFFuncs fff_elf32i386 = {
   0,
   RTAB_STANDARD,RTAB_STANDARD|RTAB_ADDEND,
   _LITTLE_ENDIAN_,
-  32,0
+  32,0,
+  FFF_ID_ELF,
+  NULL,
+  elf_splitdebug
 };
 #endif  /* ELF32_386 */
 
@@ -92,7 +95,8 @@ struct FFFuncs fff_elf32aros = {
   0,
   RTAB_STANDARD,RTAB_STANDARD|RTAB_ADDEND,
   _LITTLE_ENDIAN_,
-  32,0
+  32,0,
+  FFF_ID_ELF
 };
 
 
@@ -310,6 +314,7 @@ static uint8_t i386_reloc_vlink2elf(struct Reloc *r)
         case R_JMPSLOT: return R_386_JMP_SLOT;
         case R_GOTOFF: return R_386_GOTOFF;
         case R_GOTPC: return R_386_GOTPC;
+        case R_LOADREL: return R_386_RELATIVE;
       }
     }
   }
@@ -45,7 +45,10 @@ struct FFFuncs fff_elf32jag = {
   0,
   RTAB_ADDEND,RTAB_STANDARD|RTAB_ADDEND,
   _BIG_ENDIAN_,
-  32,1
+  32,1,
+  FFF_ID_ELF,
+  NULL,
+  elf_splitdebug
 };
 
 
@@ -50,7 +50,10 @@ struct FFFuncs fff_elf32m68k = {
   0,
   RTAB_ADDEND,RTAB_STANDARD|RTAB_ADDEND,
   _BIG_ENDIAN_,
-  32,2
+  32,2,
+  FFF_ID_ELF,
+  NULL,
+  elf_splitdebug
 };
 
 
@@ -21,6 +21,8 @@ static void ppc32be_readconv(struct GlobalVars *,struct LinkFile *);
 #if defined(ELF32_PPC_BE) || defined(ELF32_AMIGA)
 static struct Symbol *ppc32be_dynentry(struct GlobalVars *,DynArg,int);
 static void ppc32be_dyncreate(struct GlobalVars *);
+static bool ppc32be_farcall(struct GlobalVars *,struct Section *,
+                            struct Reloc *);
 static void ppc32be_writeobject(struct GlobalVars *,FILE *);
 static void ppc32be_writeshared(struct GlobalVars *,FILE *);
 static void ppc32be_writeexec(struct GlobalVars *,FILE *);
@@ -52,7 +54,10 @@ struct FFFuncs fff_elf32ppcbe = {
   0,
   RTAB_ADDEND,RTAB_ADDEND,
   _BIG_ENDIAN_,
-  32,2
+  32,2,
+  FFF_ID_ELF,
+  ppc32be_farcall,
+  elf_splitdebug
 };
 #endif
 
@@ -93,7 +98,7 @@ struct FFFuncs fff_elf32powerup = {
   RTAB_ADDEND,RTAB_ADDEND,
   _BIG_ENDIAN_,
   32,2,
-  FFF_RELOCATABLE|FFF_PSEUDO_DYNLINK
+  FFF_RELOCATABLE|FFF_PSEUDO_DYNLINK|FFF_ID_ELF
 };
 
 struct FFFuncs fff_elf32morphos = {
@@ -122,7 +127,7 @@ struct FFFuncs fff_elf32morphos = {
   RTAB_ADDEND,RTAB_ADDEND,
   _BIG_ENDIAN_,
   32,2,
-  FFF_RELOCATABLE
+  FFF_RELOCATABLE|FFF_ID_ELF
 };
 
 struct FFFuncs fff_elf32amigaos = {
@@ -153,7 +158,9 @@ struct FFFuncs fff_elf32amigaos = {
   RTAB_ADDEND,RTAB_ADDEND,
   _BIG_ENDIAN_,
   32,2,
-  FFF_DYN_RESOLVE_ALL
+  FFF_DYN_RESOLVE_ALL|FFF_ID_ELF,
+  ppc32be_farcall,
+  elf_splitdebug
 };
 
 
@@ -411,6 +418,41 @@ static void ppc32be_dyncreate(struct GlobalVars *gv)
 }
 
 
+static bool ppc32be_farcall(struct GlobalVars *gv,struct Section *stub,
+                            struct Reloc *r)
+/* Make a branch island for an out-of-range 24-bit b/bl, which loads
+   the destination into r12 and jumps there through the CTR. */
+{
+  static uint32_t code[] = {
+    0x3d800000,         /* lis   r12,dest@ha */
+    0x398c0000,         /* addi  r12,r12,dest@l */
+    0x7d8903a6,         /* mtctr r12 */
+    0x4e800420          /* bctr */
+  };
+  struct RelocInsert *ri = r->insert;
+  struct Reloc *sr;
+  int i;
+
+  if (ri==NULL || ri->next!=NULL ||
+      ri->bpos!=6 || ri->bsiz!=24 || ri->mask!=~3)
+    return FALSE;  /* not a REL24 branch */
+
+  stub->size = sizeof(code);
+  stub->data = alloc(stub->size);
+  for (i=0; i<sizeof(code)/sizeof(code[0]); i++)
+    write32be(stub->data+4*i,code[i]);
+
+  sr = stubreloc(r,2,r->addend);
+  addreloc(stub,sr,0,16,0xffff0000);  /* @ha */
+  addreloc(stub,sr,0,16,0x8000);
+  sr = stubreloc(r,6,r->addend);
+  addreloc(stub,sr,0,16,0xffff);      /* @l */
+
+  r->addend = 0;  /* branch to the first instruction of the stub */
+  return TRUE;
+}
+
+
 #ifdef ELF32_AMIGA
 
 static struct Section *ddrelocs_sec(struct GlobalVars *gv,
@@ -688,8 +688,7 @@ static void elf64_makehash(struct GlobalVars *gv)
     hdata = (uint64_t *)hashsec->data;
     write64(be,&hdata[0],nbuckets);
     write64(be,&hdata[1],nsyms);
-    for (sn=(struct SymbolNode *)elfdsymlist.l.first;
-         sn->n.next!=NULL; sn=(struct SymbolNode *)sn->n.next) {
+    for (sn=elfdsymlist.nodes; sn<elfdsymlist.nodes+nsyms; sn++) {
       uint64_t *i = &hdata[2 + elf_hash(sn->name) % nbuckets];
       uint64_t j;
 
@@ -773,6 +772,17 @@ void elf64_dyncreate(struct GlobalVars *gv,const char *pltgot_name)
       elf64_dynamicentry(gv,DT_RELSZ,elfdynrelocs->size,NULL);
       elf64_dynamicentry(gv,DT_RELENT,sizeof(struct Elf64_Rel),NULL);
     }
+    /* number of leading relative relocations, when sorted */
+    if (gv->dynreloc_format!=DYNREL_UNSORTED && elfrelcount>0)
+      elf64_dynamicentry(gv,gv->reloctab_format==RTAB_ADDEND?
+                         DT_RELACOUNT:DT_RELCOUNT,elfrelcount,NULL);
+  }
+  /* do we have packed relative relocations? */
+  if (elfrelrrelocs) {
+    elf_relrsize(gv);
+    elf64_dynamicentry(gv,DT_RELR,0,elfrelrrelocs);
+    elf64_dynamicentry(gv,DT_RELRSZ,elfrelrrelocs->size,NULL);
+    elf64_dynamicentry(gv,DT_RELRENT,sizeof(uint64_t),NULL);
   }
   /* end tag */
   elf64_dynamicentry(gv,DT_NULL,0,NULL);
@@ -950,6 +960,10 @@ static void elf64_sec2shdr(struct LinkedSection *ls,bool bss,uint64_t f)
 
   if (!strncmp(ls->name,note_name,strlen(note_name)))
     type = SHT_NOTE;
+  else if (!strcmp(ls->name,relr_name)) {
+    type = SHT_RELR;
+    entsize = sizeof(uint64_t);
+  }
   else if (!strncmp(ls->name,".rela",5)) {
     type = SHT_RELA;
     entsize = sizeof(struct Elf64_Rela);
@@ -1099,6 +1113,7 @@ static size_t elf64_putdynreloc(struct GlobalVars *gv,struct LinkedSection *ls,
 {
   const char *fn = "elf64_putdynreloc()";
   struct Elf64_Rela *rp = (struct Elf64_Rela *)dst;
+  lword a = rel->addend;
   uint32_t symidx;
   uint8_t rtype;
 
@@ -1110,6 +1125,11 @@ static size_t elf64_putdynreloc(struct GlobalVars *gv,struct LinkedSection *ls,
       ierror("%s no symbol <%s> in dyn.table",fn,rel->xrefname);
     symidx = sn->index;
   }
+  else if (rel->rtype == R_LOADREL) {
+    /* relative to load address, the addend is the link address */
+    symidx = 0;
+    a += (lword)rel->relocsect.lnk->base;
+  }
   else
     ierror("%s no symbol base",fn);
 
@@ -1128,11 +1148,11 @@ static size_t elf64_putdynreloc(struct GlobalVars *gv,struct LinkedSection *ls,
   write64(be,rp->r_info,ELF64_R_INFO((uint64_t)symidx,(uint64_t)rtype));
 
   if (rela) {
-    write64(be,rp->r_addend,rel->addend);
+    write64(be,rp->r_addend,a);
     writesection(gv,ls->data,rel->offset,rel,0);
     return sizeof(struct Elf64_Rela);
   }
-  writesection(gv,ls->data,rel->offset,rel,rel->addend);
+  writesection(gv,ls->data,rel->offset,rel,a);
   return sizeof(struct Elf64_Rel);
 }
 
@@ -1145,6 +1165,8 @@ static void elf64_makedynamic(struct GlobalVars *gv,
     bool be = elf_endianness == _BIG_ENDIAN_;
     int rela = gv->reloctab_format==RTAB_ADDEND ? 1 : 0;
     struct LinkedSection *ls;
+    struct DynRelocRef *drr;
+    unsigned long i,n;
     uint8_t *dynp,*pltp;
 
     if (ls = find_lnksec(gv,dynrel_name[rela],0,0,0,0))
@@ -1157,20 +1179,24 @@ static void elf64_makedynamic(struct GlobalVars *gv,
       pltp = NULL;
 
     /* write dynamic relocations */
+    elf_putrelr(gv);
+    drr = elf_dynrelocs(gv,&n);
+    for (i=0; i<n; i++) {
+      if (dynp == NULL)
+        ierror("%s %s lost",fn,dynrel_name[rela]);
+      dynp += elf64_putdynreloc(gv,drr[i].ls,drr[i].rel,dynp,
+                                reloc_vlink2elf,rela,be);
+    }
+    free(drr);
+
+    /* write PLT relocations */
     for (ls=(struct LinkedSection *)gv->lnksec.first;
          ls->n.next!=NULL; ls=(struct LinkedSection *)ls->n.next) {
       struct Reloc *rel = (struct Reloc *)ls->xrefs.first;
       struct Reloc *nextrel;
 
       while (nextrel = (struct Reloc *)rel->n.next) {
-        if (rel->flags & RELF_DYN) {
-          if (dynp == NULL)
-            ierror("%s %s lost",fn,dynrel_name[rela]);
-          dynp += elf64_putdynreloc(gv,ls,rel,dynp,reloc_vlink2elf,rela,be);
-          remnode(&rel->n);
-          /* free rel */
-        }
-        else if (rel->flags & RELF_PLT) {
+        if (rel->flags & RELF_PLT) {
           if (pltp == NULL)
             ierror("%s %s lost",fn,pltrel_name[rela]);
           pltp += elf64_putdynreloc(gv,ls,rel,pltp,reloc_vlink2elf,rela,be);
@@ -21,6 +21,8 @@ static void x86_64_dyncreate(struct GlobalVars *);
 static void x86_64_writeobject(struct GlobalVars *,FILE *);
 static void x86_64_writeshared(struct GlobalVars *,FILE *);
 static void x86_64_writeexec(struct GlobalVars *,FILE *);
+static bool x86_64_gotrelax(struct GlobalVars *,struct Section *,
+                            struct Reloc *);
 
 struct FFFuncs fff_elf64x86 = {
   "elf64x86",
@@ -49,7 +51,11 @@ struct FFFuncs fff_elf64x86 = {
   0,
   RTAB_ADDEND,RTAB_STANDARD|RTAB_ADDEND,
   _LITTLE_ENDIAN_,
-  64,0
+  64,0,
+  FFF_ID_ELF,
+  NULL,
+  elf_splitdebug,
+  x86_64_gotrelax
 };
 
 
@@ -90,10 +96,37 @@ static uint8_t x86_64_reloc_elf2vlink(uint8_t rtype,struct RelocInsert *ri)
     R_ABS,0,16,-1,              /* R_X86_64_16 */
     R_PC,0,16,-1,               /* R_X86_64_PC16 */
     R_ABS,0,8,-1,               /* R_X86_64_8 */
-    R_PC,0,8,-1                 /* R_X86_64_PC8 */
+    R_PC,0,8,-1,                /* R_X86_64_PC8 */
+    R_NONE,0,0,-1,              /* R_X86_64_DTPMOD64 */
+    R_NONE,0,0,-1,              /* R_X86_64_DTPOFF64 */
+    R_NONE,0,0,-1,              /* R_X86_64_TPOFF64 */
+    R_NONE,0,0,-1,              /* R_X86_64_TLSGD */
+    R_NONE,0,0,-1,              /* R_X86_64_TLSLD */
+    R_NONE,0,0,-1,              /* R_X86_64_DTPOFF32 */
+    R_NONE,0,0,-1,              /* R_X86_64_GOTTPOFF */
+    R_NONE,0,0,-1,              /* R_X86_64_TPOFF32 */
+    R_PC,0,64,-1,               /* R_X86_64_PC64 */
+    R_GOTOFF,0,64,-1,           /* R_X86_64_GOTOFF64 */
+    R_NONE,0,0,-1,              /* R_X86_64_GOTPC32 */
+    R_GOT,0,64,-1,              /* R_X86_64_GOT64 */
+    R_GOTPC,0,64,-1,            /* R_X86_64_GOTPCREL64 */
+    R_NONE,0,0,-1,              /* R_X86_64_GOTPC64 */
+    R_NONE,0,0,-1,              /* R_X86_64_GOTPLT64 */
+    R_PLTOFF,0,64,-1,           /* R_X86_64_PLTOFF64 */
+    R_NONE,0,0,-1,              /* R_X86_64_SIZE32 */
+    R_NONE,0,0,-1,              /* R_X86_64_SIZE64 */
+    R_NONE,0,0,-1,              /* R_X86_64_GOTPC32_TLSDESC */
+    R_NONE,0,0,-1,              /* R_X86_64_TLSDESC_CALL */
+    R_NONE,0,0,-1,              /* R_X86_64_TLSDESC */
+    R_NONE,0,0,-1,              /* R_X86_64_IRELATIVE */
+    R_NONE,0,0,-1,              /* R_X86_64_RELATIVE64 */
+    R_NONE,0,0,-1,              /* 39: deprecated R_X86_64_PC32_BND */
+    R_NONE,0,0,-1,              /* 40: deprecated R_X86_64_PLT32_BND */
+    R_GOTPCX,0,32,-1,           /* R_X86_64_GOTPCRELX */
+    R_GOTPCXREX,0,32,-1         /* R_X86_64_REX_GOTPCRELX */
   };
 
-  if (rtype <= R_X86_64_PC8) {
+  if (rtype <= R_X86_64_REX_GOTPCRELX) {
     ri->bpos = convertV4[rtype].bpos;
     ri->bsiz = convertV4[rtype].bsiz;
     ri->mask = convertV4[rtype].mask;
@@ -176,6 +209,40 @@ static void x86_64_dyncreate(struct GlobalVars *gv)
 }
 
 
+static bool x86_64_gotrelax(struct GlobalVars *gv,struct Section *sec,
+                            struct Reloc *r)
+/* A GOTPCRELX reference to a locally defined symbol doesn't need a GOT
+   entry. Convert the instruction into a direct pc-relative access:
+     mov foo@GOTPCREL(%rip),%reg -> lea foo(%rip),%reg
+     call *foo@GOTPCREL(%rip)    -> addr32 call foo
+     jmp *foo@GOTPCREL(%rip)     -> jmp foo; nop */
+{
+  uint8_t *p;
+
+  if (r->offset<2 || r->offset+4>sec->size || sec->data==NULL)
+    return FALSE;
+  p = sec->data + r->offset;
+
+  if (p[-2]==0x8b && (p[-1]&0xc7)==0x05) {
+    p[-2] = 0x8d;  /* lea with the same register and %rip-relative EA */
+  }
+  else if (p[-2]==0xff && p[-1]==0x15) {
+    p[-2] = 0x67;  /* addr32 prefix keeps the instruction size */
+    p[-1] = 0xe8;
+  }
+  else if (p[-2]==0xff && p[-1]==0x25) {
+    p[-2] = 0xe9;
+    p[3] = 0x90;   /* jmp rel32 is one byte shorter, pad with nop */
+    r->offset--;
+  }
+  else
+    return FALSE;
+
+  r->rtype = R_PC;
+  return TRUE;
+}
+
+
 
 /*****************************************************************/
 /*                          Write ELF                            */
@@ -192,8 +259,11 @@ static uint8_t x86_64_reloc_vlink2elf(struct Reloc *r)
   else if (isstdreloc(r,R_PC,8)) return R_X86_64_PC8;
   else if (isstdreloc(r,R_PC,16)) return R_X86_64_PC16;
   else if (isstdreloc(r,R_PC,32)) return R_X86_64_PC32;
+  else if (isstdreloc(r,R_PC,64)) return R_X86_64_PC64;
   else if (isstdreloc(r,R_GOT,32)) return R_X86_64_GOT32;
   else if (isstdreloc(r,R_GOTPC,32)) return R_X86_64_GOTPCREL; /* @@@ */
+  else if (isstdreloc(r,R_GOTPCX,32)) return R_X86_64_GOTPCRELX;
+  else if (isstdreloc(r,R_GOTPCXREX,32)) return R_X86_64_REX_GOTPCRELX;
   else if (isstdreloc(r,R_PLT,32)) return R_X86_64_PLT32;
   else if (r->rtype == R_COPY) return R_X86_64_COPY;
   else if (r->rtype == R_GLOBDAT) return R_X86_64_GLOB_DAT;
@@ -342,7 +342,7 @@ struct FFFuncs fff_bbc = {
   RTAB_UNDEF,0,
   _LITTLE_ENDIAN_,
   16,0,
-  FFF_SECTOUT
+  FFF_SECTOUT|FFF_EXTRAFILES
 };
 struct FFFuncs fff_bbc2 = {
   "bbc2",
@@ -370,7 +370,7 @@ struct FFFuncs fff_bbc2 = {
   RTAB_UNDEF,0,
   _LITTLE_ENDIAN_,
   16,0,
-  FFF_SECTOUT
+  FFF_SECTOUT|FFF_EXTRAFILES
 };
 #endif
 
@@ -1502,17 +1502,41 @@ static void sincql_write(struct GlobalVars *gv,FILE *f)
 }
 #endif
 
-#if defined(SREC19) || defined(SREC28) || defined(SREC37)
-static void SRecOut(FILE *f,int stype,uint8_t *buf,int len)
+#if defined(SREC19) || defined(SREC28) || defined(SREC37) || \
+    defined(IHEX) || defined(SHEX1)
+static char *hexbytes(char *d,uint8_t *s,int len,uint8_t *sum)
+/* Write len bytes from s as pairs of hex digits to d and add them
+   to the checksum in *sum. Returns the new end of the string. */
 {
-  uint8_t chksum = 0xff-len-1;
+  static const char hexdigits[] = "0123456789ABCDEF";
+  uint8_t c = *sum;
 
-  fprintf(f,"S%1d%02X",stype,(unsigned)(len+1));
   for (; len>0; len--) {
-    fprintf(f,"%02X",(unsigned)*buf);
-    chksum -= *buf++;
+    *d++ = hexdigits[*s >> 4];
+    *d++ = hexdigits[*s & 15];
+    c += *s++;
   }
-  fprintf(f,"%02X\n",(unsigned)chksum);
+  *sum = c;
+  *d = '\0';
+  return d;
+}
+#endif
+
+#if defined(SREC19) || defined(SREC28) || defined(SREC37)
+static void SRecOut(FILE *f,int stype,uint8_t *buf,int len)
+{
+  char rec[2*(MAXSREC+8)+8],*p;
+  uint8_t cnt = len + 1;
+  uint8_t chksum = 0;
+
+  rec[0] = 'S';
+  rec[1] = '0' + stype;
+  p = hexbytes(rec+2,&cnt,1,&chksum);
+  p = hexbytes(p,buf,len,&chksum);
+  chksum = ~chksum;
+  p = hexbytes(p,&chksum,1,&chksum);
+  *p++ = '\n';
+  fwrite(rec,1,p-rec,f);
 }
 
 
@@ -1620,23 +1644,36 @@ static void srec37_write(struct GlobalVars *gv,FILE *f)
 static void IHexOut(FILE *f,unsigned long addr,uint8_t *buf,int len)
 {
   static unsigned long hiaddr;
-  uint8_t chksum;
+  char rec[2*(MAXIREC+5)+8],*p;
+  uint8_t hdr[4],chksum;
 
   if (((addr&0xffff0000)>>16)!=hiaddr) {
     hiaddr = (addr&0xffff0000) >> 16;
-    fprintf(f,":02000004%02X%02X%02X\n",
-            (unsigned)(hiaddr>>8)&0xff,
-            (unsigned)hiaddr&0xff,
-            (unsigned)(-(2+4+(hiaddr>>8)+hiaddr))&0xff);
-  }
-  fprintf(f,":%02X%02X%02X00",
-          (unsigned)len&0xff,(unsigned)(addr>>8)&0xff,(unsigned)addr&0xff);
-  chksum = len + (addr>>8) + addr;
-  for (; len>0; len--) {
-    fprintf(f,"%02X",((unsigned)*buf)&0xff);
-    chksum += *buf++;
+    hdr[0] = 2;
+    hdr[1] = hdr[2] = 0;
+    hdr[3] = 4;
+    chksum = 0;
+    rec[0] = ':';
+    p = hexbytes(rec+1,hdr,4,&chksum);
+    write16be(hdr,(uint16_t)hiaddr);
+    p = hexbytes(p,hdr,2,&chksum);
+    chksum = -chksum;
+    p = hexbytes(p,&chksum,1,&chksum);
+    *p++ = '\n';
+    fwrite(rec,1,p-rec,f);
   }
-  fprintf(f,"%02X\n",(-chksum)&0xff);
+  hdr[0] = len;
+  hdr[1] = addr >> 8;
+  hdr[2] = addr;
+  hdr[3] = 0;
+  chksum = 0;
+  rec[0] = ':';
+  p = hexbytes(rec+1,hdr,4,&chksum);
+  p = hexbytes(p,buf,len,&chksum);
+  chksum = -chksum;
+  p = hexbytes(p,&chksum,1,&chksum);
+  *p++ = '\n';
+  fwrite(rec,1,p-rec,f);
 }
 
 
@@ -1684,19 +1721,22 @@ static void ihex_write(struct GlobalVars *gv,FILE *f)
 #ifdef SHEX1
 static void SHex1Out(FILE *f,unsigned long addr,uint8_t *buf,int len)
 {
+  static uint8_t zero[4];
   int wordcnt=(len+3)/4;
+  char rec[128],*p;
+  uint8_t sum = 0;  /* unused */
   int i;
 
-  fprintf(f,"%06lX %d",addr,wordcnt);
+  p = rec + sprintf(rec,"%06lX %d",addr,wordcnt);
 
-  for(i=0;i<len;i++){
-    if((i&3)==0)
-      fprintf(f," ");
-    fprintf(f,"%02X",buf[i]);
+  for (i=0; i<len; i+=4) {
+    *p++ = ' ';
+    p = hexbytes(p,buf+i,len-i<4?len-i:4,&sum);
   }
-  for(i=0;i<wordcnt*4-len;i++)
-    fprintf(f,"00");
-  fprintf(f,"\n");
+  if (len & 3)
+    p = hexbytes(p,zero,4-(len&3),&sum);
+  *p++ = '\n';
+  fwrite(rec,1,p-rec,f);
 }
 
 
@@ -68,7 +68,8 @@ struct FFFuncs fff_rawseg = {
   0,
   RTAB_UNDEF,0,
   -1,   /* endianness undefined, only write */
-  0,0   /* addr_bits from input */
+  0,0,  /* addr_bits from input */
+  FFF_EXTRAFILES
 };
 #endif
 
@@ -103,7 +103,8 @@ struct FFFuncs fff_vobj_le = {
   RTAB_UNDEF,0,
   _LITTLE_ENDIAN_,
   0,  /* defined by VOBJ bytespertaddr*bitsperbyte */
-  0   /* irrelevant - no output format */
+  0,  /* irrelevant - no output format */
+  FFF_ID_VOBJ
 };
 
 struct FFFuncs fff_vobj_be = {
@@ -132,7 +133,8 @@ struct FFFuncs fff_vobj_be = {
   RTAB_UNDEF,0,
   _BIG_ENDIAN_,
   0,  /* defined by VOBJ bytespertaddr*bitsperbyte */
-  0   /* irrelevant - no output format */
+  0,  /* irrelevant - no output format */
+  FFF_ID_VOBJ
 };
 
 
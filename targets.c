@@ -170,12 +170,13 @@ const char *reloc_name[] = {
   "R_COPY",
   "R_JMPSLOT",
   "R_SECOFF",
-  "","","","","","","","","","","","","","",""
+  "","","","","","","","","","","","","","","",
   "R_SD2",
   "R_SD21",
-  "R_SECOFF",
   "R_MOSDREL",
   "R_AOSBREL",
+  "R_GOTPCX",
+  "R_GOTPCXREX",
   NULL
 };
 
@@ -352,6 +353,8 @@ bool addglobsym(struct GlobalVars *gv,struct Symbol *newsym)
   struct Symbol *sym;
   struct ObjectUnit *newou = newsym->relsect ? newsym->relsect->obj : NULL;
 
+  symcache_invalidate(newsym->name);
+
   while (sym = *chain) {
     if (!strcmp(newsym->name,sym->name)) {
 
@@ -493,6 +496,29 @@ static void add_objsymbol(struct ObjectUnit *ou,struct Symbol *newsym)
 }
 
 
+static struct Symbol *newsymbol(struct GlobalVars *gv,struct Section *s,
+                                const char *name,const char *iname,lword val,
+                                uint8_t type,uint8_t flags,uint8_t info,
+                                uint8_t bind,uint32_t size)
+/* allocate and initialize a new symbol, which is not yet linked anywhere */
+{
+  struct Symbol *sym = alloczero(sizeof(struct Symbol));
+
+  sym->name = name;
+  sym->indir_name = iname;
+  sym->value = val;
+  sym->relsect = s;
+  sym->type = type;
+  sym->flags = flags;
+  sym->info = info;
+  sym->bind = bind;
+  sym->size = size;
+  if (check_protection(gv,name))
+    sym->flags |= SYMF_PROTECTED;
+  return sym;
+}
+
+
 struct Symbol *addsymbol(struct GlobalVars *gv,struct Section *s,
                          const char *name,const char *iname,lword val,
                          uint8_t type,uint8_t flags,uint8_t info,uint8_t bind,
@@ -534,16 +560,7 @@ struct Symbol *addsymbol(struct GlobalVars *gv,struct Section *s,
   }
 
   /* new symbol */
-  sym = alloczero(sizeof(struct Symbol));
-  sym->name = name;
-  sym->indir_name = iname;
-  sym->value = val;
-  sym->relsect = s;
-  sym->type = type;
-  sym->flags = flags;
-  sym->info = info;
-  sym->bind = bind;
-  sym->size = size;
+  sym = newsymbol(gv,s,name,iname,val,type,flags,info,bind,size);
   sym->fmask = fmask;
 
   if (type == SYM_COMMON) {
@@ -610,18 +627,23 @@ void addlocsymbol(struct GlobalVars *gv,struct Section *s,char *name,
 
   while (sym = *chain)
     chain = &sym->obj_chain;
-  *chain = sym = alloczero(sizeof(struct Symbol));
-  sym->name = name;
-  sym->indir_name = iname;
-  sym->value = val;
-  sym->relsect = s;
-  sym->type = type;
-  sym->flags = flags;
-  sym->info = info;
-  sym->bind = SYMB_LOCAL;
-  sym->size = size;
-  if (check_protection(gv,name))
-    sym->flags |= SYMF_PROTECTED;
+  *chain = newsymbol(gv,s,name,iname,val,type,flags,info,SYMB_LOCAL,size);
+}
+
+
+struct Symbol *adduniqsymbol(struct GlobalVars *gv,struct Section *s,
+                             const char *name,lword val,uint8_t type,
+                             uint8_t info,uint32_t size)
+/* Define a new local symbol, whose name is known to be unique within
+   the object unit, so it can be inserted at the head of its hash chain. */
+{
+  struct Symbol *sym;
+  struct Symbol **chain = &s->obj->objsyms[elf_hash(name)%OBJSYMHTABSIZE];
+
+  sym = newsymbol(gv,s,name,NULL,val,type,0,info,SYMB_LOCAL,size);
+  sym->obj_chain = *chain;
+  *chain = sym;
+  return sym;
 }
 
 
@@ -827,6 +849,7 @@ void pull_objunit(struct GlobalVars *gv,struct ObjectUnit *ou)
         struct Symbol **chain = &gv->symbols[elf_hash(sym->name)%SYMHTABSIZE];
         struct Symbol *gsym;
 
+        symcache_invalidate(sym->name);
         while (gsym = *chain) {
           if (!strcmp(sym->name,gsym->name))
             check_global_objsym(ou,chain,gsym,sym);
@@ -973,6 +996,22 @@ struct Reloc *newreloc(struct GlobalVars *gv,struct Section *sec,
 }
 
 
+struct Reloc *stubreloc(struct Reloc *branch,unsigned long offset,
+                        lword addend)
+/* allocate a new absolute relocation, which refers to the same
+   destination as 'branch', for use in a far-call stub */
+{
+  struct Reloc *r = alloczero(sizeof(struct Reloc));
+
+  r->xrefname = branch->xrefname;
+  r->relocsect = branch->relocsect;
+  r->offset = offset;
+  r->addend = addend;
+  r->rtype = R_ABS;
+  return r;
+}
+
+
 void addreloc(struct Section *sec,struct Reloc *r,
               uint16_t pos,uint16_t siz,lword mask)
 /* Add a relocation description of the current type to this relocation,
@@ -1156,6 +1195,15 @@ lword readsection(struct GlobalVars *gv,uint8_t rtype,
 }
 
 
+static bool signed_reloc(uint8_t t)
+/* relocation types which insert a signed value */
+{
+  return t==R_PC||t==R_GOTPC||t==R_GOTOFF||t==R_PLTPC||t==R_PLTOFF||
+         t==R_SD||t==R_SD2||t==R_SD21||t==R_MOSDREL||t==R_GOTPCX||
+         t==R_GOTPCXREX;
+}
+
+
 lword writesection(struct GlobalVars *gv,uint8_t *dest,size_t secoffs,
                    struct Reloc *r,lword v)
 /* Write 'v' into the bit-field defined by the relocation type in 'r'.
@@ -1165,8 +1213,7 @@ lword writesection(struct GlobalVars *gv,uint8_t *dest,size_t secoffs,
 {
   bool be = gv->endianness != _LITTLE_ENDIAN_;
   uint8_t t = r->rtype;
-  bool signedval = t==R_PC||t==R_GOTPC||t==R_GOTOFF||t==R_PLTPC||t==R_PLTOFF||
-                   t==R_SD||t==R_SD2||t==R_SD21||t==R_MOSDREL;
+  bool signedval = signed_reloc(t);
   struct RelocInsert *ri;
 
   if (t == R_NONE)
@@ -1203,6 +1250,34 @@ lword writesection(struct GlobalVars *gv,uint8_t *dest,size_t secoffs,
 }
 
 
+bool checkreloc(struct Reloc *r,lword v)
+/* Check whether 'v' would fit into all bit-fields of relocation 'r',
+   using the same range checks as writesection(). Additionally a signed
+   value for a single bit-field must not be truncated by its mask. */
+{
+  bool signedval = signed_reloc(r->rtype);
+  struct RelocInsert *ri;
+
+  if (r->rtype == R_NONE)
+    return TRUE;
+
+  for (ri=r->insert; ri!=NULL; ri=ri->next) {
+    lword mask = ri->mask;
+    lword insval = (v & mask) >> lshiftcnt(mask);
+
+    if (mask>=0 && signedval) {
+      if (ri==r->insert && ri->next==NULL)
+        insval = v >> lshiftcnt(mask);
+      else
+        insval = sign_extend(insval,ri->bsiz);
+    }
+    if (!checkrange(insval,signedval,ri->bsiz))
+      return FALSE;
+  }
+  return TRUE;
+}
+
+
 int writetaddr(struct GlobalVars *gv,void *dst,size_t offs,lword d)
 {
   bool be = gv->endianness == _BIG_ENDIAN_;
@@ -1290,93 +1365,135 @@ void calc_relocs(struct GlobalVars *gv,struct LinkedSection *ls)
 }
 
 
-static int reloc_offset_cmp(const void *left,const void *right)
-/* qsort: compare relocation offsets */
-{
-  unsigned long offsl = (*(struct Reloc **)left)->offset;
-  unsigned long offsr = (*(struct Reloc **)right)->offset;
-
-  return (offsl<offsr) ? -1 : ((offsl>offsr) ? 1 : 0);
-}
-
-
 void sort_relocs(struct list *rlist)
 /* sorts a section's relocation list by their section offsets */
 {
-  struct Reloc *rel,**rel_ptr_array,**p;
-  int cnt = 0;
+  struct SortKey *keys;
+  struct Reloc *rel;
+  unsigned long cnt=0,i;
 
-  /* count relocs and make a pointer array */
+  /* count relocs and make a key array */
   for (rel=(struct Reloc *)rlist->first; rel->n.next!=NULL;
        rel=(struct Reloc *)rel->n.next)
     cnt++;
   if (cnt > 1) {
-    rel_ptr_array = alloc(cnt * sizeof(void *));
-    for (rel=(struct Reloc *)rlist->first,p=rel_ptr_array;
-         rel->n.next!=NULL; rel=(struct Reloc *)rel->n.next)
-      *p++ = rel;
+    keys = alloc(cnt * sizeof(struct SortKey));
+    for (rel=(struct Reloc *)rlist->first,i=0;
+         rel->n.next!=NULL; rel=(struct Reloc *)rel->n.next,i++) {
+      keys[i].key = rel->offset;
+      keys[i].ptr = rel;
+    }
 
-    /* sort pointer array */
-    qsort(rel_ptr_array,cnt,sizeof(void *),reloc_offset_cmp);
+    radix_sort(keys,cnt);
 
-    /* rebuild reloc list from sorted pointer array, then free it */
+    /* rebuild reloc list from sorted key array, then free it */
     initlist(rlist);
-    for (p=rel_ptr_array; cnt; cnt--) {
-      rel = *p++;
-      addtail(rlist,&rel->n);
-    }
-    free(rel_ptr_array);
+    for (i=0; i<cnt; i++)
+      addtail(rlist,&((struct Reloc *)keys[i].ptr)->n);
+    free(keys);
   }
 }
 
 
 void add_priptrs(struct GlobalVars *gv,struct ObjectUnit *ou)
-/* Inserts all PriPointer nodes of an object into the global list. */
-/* The node's position depends on 1. section name, 2. list name, */
-/* 3. priority. */
+/* Appends all PriPointer nodes of an object to the global list. */
+/* They are sorted once by sort_priptrs(), before being used. */
 {
-  struct PriPointer *newpp,*nextpp,*pp;
+  struct PriPointer *pp;
 
-  while (newpp = (struct PriPointer *)remhead(&ou->pripointers)) {
-    pp = (struct PriPointer *)gv->pripointers.first;
+  while (pp = (struct PriPointer *)remhead(&ou->pripointers))
+    addtail(&gv->pripointers,&pp->n);
+}
 
-    while (nextpp = (struct PriPointer *)pp->n.next) {
-      int c;
 
-      if ((c = strcmp(newpp->secname,pp->secname)) > 0)
-        break;
+static int priptr_cmp(const void *left,const void *right)
+/* qsort: compare 1. section name, 2. list name, 3. priority, 4. order */
+{
+  const struct PriPointer *pp1 = *(const struct PriPointer **)left;
+  const struct PriPointer *pp2 = *(const struct PriPointer **)right;
+  int c;
 
-      if (!c) {
-        if ((c = strcmp(newpp->listname,pp->listname)) > 0)
-          break;
+  if (c = strcmp(pp2->secname,pp1->secname))
+    return c;
+  if (c = strcmp(pp2->listname,pp1->listname))
+    return c;
+  if (pp1->priority != pp2->priority)
+    return pp1->priority < pp2->priority ? -1 : 1;
+  return pp1->seq < pp2->seq ? -1 : (pp1->seq > pp2->seq ? 1 : 0);
+}
 
-        if (!c) {
-          if (newpp->priority < pp->priority)
-            break;
 
-          if (newpp->priority==pp->priority &&
-              !strcmp(newpp->xrefname+1,pp->xrefname+1)) {
-            /* same priority and identical name, except for first character */
-            if (*newpp->xrefname == *pp->xrefname)
-              error(151,getobjname(ou),newpp->xrefname);  /* duplicate */
-            else if (*newpp->xrefname == '@') {
-              /* @(fastcall) PriPointer replaces _(standard) */
-              remnode(&pp->n);
-              pp = nextpp;
-              break;
-            }
-            newpp = NULL;  /* do not insert, ignore */
-            break;
-          }
-        }
-      }
+static int priptr_name_cmp(const void *left,const void *right)
+/* qsort: like priptr_cmp(), but compare names before the order */
+{
+  const struct PriPointer *pp1 = *(const struct PriPointer **)left;
+  const struct PriPointer *pp2 = *(const struct PriPointer **)right;
+  int c;
+
+  if (c = strcmp(pp2->secname,pp1->secname))
+    return c;
+  if (c = strcmp(pp2->listname,pp1->listname))
+    return c;
+  if (pp1->priority != pp2->priority)
+    return pp1->priority < pp2->priority ? -1 : 1;
+  if (c = strcmp(pp1->xrefname+1,pp2->xrefname+1))
+    return c;
+  return pp1->seq < pp2->seq ? -1 : (pp1->seq > pp2->seq ? 1 : 0);
+}
+
+
+static void sort_priptrs(struct GlobalVars *gv)
+/* Sort the global PriPointer list by section name, list name and
+   priority, keeping the order of insertion for identical keys.
+   Pointers with the same priority and name, except for the first
+   character, are duplicates. An @(fastcall) PriPointer replaces
+   a _(standard) one, taking its position, otherwise the later
+   one is ignored. */
+{
+  struct PriPointer *pp,*kept,**pparray;
+  unsigned long i,n;
 
-      pp = nextpp;
+  for (n=0,pp=(struct PriPointer *)gv->pripointers.first;
+       pp->n.next!=NULL; pp=(struct PriPointer *)pp->n.next)
+    pp->seq = n++;
+  if (n == 0)
+    return;
+  pparray = alloc(n * sizeof(struct PriPointer *));
+  for (i=0; pp=(struct PriPointer *)remhead(&gv->pripointers); i++)
+    pparray[i] = pp;
+
+  /* find duplicates, which are neighbours now */
+  qsort(pparray,n,sizeof(struct PriPointer *),priptr_name_cmp);
+  for (i=0,kept=NULL; i<n; i++) {
+    pp = pparray[i];
+    if (kept!=NULL && kept->priority==pp->priority &&
+        !strcmp(kept->secname,pp->secname) &&
+        !strcmp(kept->listname,pp->listname) &&
+        !strcmp(kept->xrefname+1,pp->xrefname+1)) {
+      /* same priority and identical name, except for first character */
+      if (*pp->xrefname == *kept->xrefname)
+        error(151,getobjname(pp->obj),pp->xrefname);  /* duplicate */
+      else if (*pp->xrefname == '@') {
+        /* @(fastcall) PriPointer replaces _(standard) */
+        pp->seq = kept->seq;
+        kept->seq = ~0UL;
+        kept = pp;
+        continue;
+      }
+      pp->seq = ~0UL;  /* do not insert, ignore */
     }
+    else
+      kept = pp;
+  }
 
-    if (newpp)
-      insertbefore(&newpp->n,&pp->n);
+  qsort(pparray,n,sizeof(struct PriPointer *),priptr_cmp);
+  for (i=0; i<n; i++) {
+    if (pparray[i]->seq != ~0UL)
+      addtail(&gv->pripointers,&pparray[i]->n);
+    else
+      free(pparray[i]);
   }
+  free(pparray);
 }
 
 
@@ -1391,6 +1508,7 @@ static void new_priptr(struct ObjectUnit *ou,const char *sec,const char *label,
   newpp->priority = pri;
   newpp->xrefname = xref;
   newpp->addend = addend;
+  newpp->obj = ou;
   addtail(&ou->pripointers,&newpp->n);
 }
 
@@ -1660,6 +1778,7 @@ struct ObjectUnit *create_objunit(struct GlobalVars *gv,
   initlist(&ou->pripointers);  /* empty PriPointer list */
   ou->flags = 0;
   ou->min_alignment = gv->min_alignment;
+  ou->extra = 0;
   return ou;
 }
 
@@ -2126,6 +2245,8 @@ void make_constructors(struct GlobalVars *gv)
     struct ObjectUnit *ou;
     size_t asize;
 
+    sort_priptrs(gv);
+
     /* check if constructors or destructors are needed (referenced) */
     if (gv->ctor_symbol) {
       if (gv->ctor_symbol->flags & SYMF_REFERENCED) {
@@ -2436,23 +2557,47 @@ void untrim_sections(struct GlobalVars *gv)
 }
 
 
+struct LMASec {
+  struct LinkedSection *ls;
+  int pos;                      /* position in gv->lnksec */
+};
+
+static int lnksec_lma_cmp(const void *left,const void *right)
+/* qsort: compare load addresses of linked sections, then their position */
+{
+  const struct LMASec *s1 = (const struct LMASec *)left;
+  const struct LMASec *s2 = (const struct LMASec *)right;
+
+  if (s1->ls->copybase != s2->ls->copybase)
+    return s1->ls->copybase < s2->ls->copybase ? -1 : 1;
+  return s1->pos - s2->pos;
+}
+
+
 struct LinkedSection *load_next_section(struct GlobalVars *gv)
 /* return pointer to next section with lowest LMA and remove it from list */
 {
-  struct LinkedSection *ls = (struct LinkedSection *)gv->lnksec.first;
-  struct LinkedSection *nextls,*minls = NULL;
-
-  while (nextls = (struct LinkedSection *)ls->n.next) {
-    if (minls) {
-      if (ls->copybase < minls->copybase)
-        minls = ls;
+  struct LinkedSection *ls;
+  struct LMASec *lsarray;
+  int i,n;
+
+  if (!gv->lnksec_sorted) {
+    /* sort the list by LMA once, on the first call */
+    for (n=0,ls=(struct LinkedSection *)gv->lnksec.first;
+         ls->n.next!=NULL; ls=(struct LinkedSection *)ls->n.next)
+      n++;
+    if (n > 1) {
+      lsarray = alloc(n * sizeof(struct LMASec));
+      for (i=0; ls=(struct LinkedSection *)remhead(&gv->lnksec); i++) {
+        lsarray[i].ls = ls;
+        lsarray[i].pos = i;
+      }
+      qsort(lsarray,n,sizeof(struct LMASec),lnksec_lma_cmp);
+      for (i=0; i<n; i++)
+        addtail(&gv->lnksec,&lsarray[i].ls->n);
+      free(lsarray);
     }
-    else
-      minls = ls;
-    ls = nextls;
-  }
-  if (minls) {
-    remnode(&minls->n);
+    gv->lnksec_sorted = TRUE;
   }
-  return minls;
+  return (struct LinkedSection *)remhead(&gv->lnksec);
 }
@@ -17,6 +17,7 @@
 static const char *_ver = "$VER: " PNAME " " VERSION " " __AMIGADATE__ "\r\n";
 #endif
 const char *version_str = VERSION;
+const char *build_date = __DATE__ " " __TIME__;
 
 
 
@@ -33,25 +34,28 @@ void show_usage(void)
 
   printf("Usage: " PNAME " [-dhkmnqrstvwxMRSXZ] [-B linkmode] [-b targetname] "
          "[-baseoff offset] [-C constructor-type] [-Crel] "
+         "[-cache dir] [-cachesize bytes] [-callgraph] [-combreloc] "
 #if 0 /* not implemented */
          "[-D symbol[=value]] "
 #endif
-         "[-da] [-dc] [-dp] [-EB] [-EL] [-e entrypoint] [-export-dynamic] "
+         "[-da] [-dc] [-dp] [-debugfile filename] "
+         "[-EB] [-EL] [-e entrypoint] [-export-dynamic] "
          "[-f flavour] [-fixunnamed] [-F filename] "
-         "[-gc-all] [-gc-empty] "
-         "[-hunkattr secname=value] [-interp path] "
-         "[-L library-search-path] [-l library-specifier] [-minalign value] "
-         "[-mrel] [-mtype] [-mall] [-multibase] [-nostdlib] "
-         "[-N old new] [-o filename] [-osec] "
+         "[-gc-all] [-gc-empty] [-hugepages] "
+         "[-hunkattr secname=value] [-hunkoverlay level] [-interp path] "
+         "[-L library-search-path] [-l library-specifier] [-mapcsv filename] "
+         "[-minalign value] [-mrel] [-mtype] [-mall] [-multibase] [-nostdlib] "
+         "[-N old new] [-o filename] [-osec] [-pack] "
          "[-os9-mem/name/rev] [-P symbol] "
-         "[-rpath path] [-sc] [-sd] [-shared] [-soname name] [-static] "
-         "[-T filename] [-Ttext addr] [-textbaserel] "
+         "[-relr] [-rpath path] [-sc] [-sd] [-sdrefs] [-shared] [-soname name] "
+         "[-static] [-symorder filename] "
+         "[-T filename] [-Ttext addr] [-textbaserel] [-time] "
          "[-tos-flags/fastload/fastram/private/global/super/readable] "
          "[-u symbol] [-vicelabels filename]"
          "[-V version] [-y symbol] "
-         "input-files...\n\nOptions:\n"
+         "input-files...\n\nOptions:\n");
 
-         "<input-files>     object files and libraries to link\n"
+  printf("<input-files>     object files and libraries to link\n"
          "-F<file>          read a list of input files from <file>\n"
          "-o<output>        output file name\n"
          "-b<target>        output file format\n"
@@ -76,6 +80,9 @@ void show_usage(void)
          "-V<version>       minimum version of shared object\n"
          "-C<constr.type>   Set type of con-/destructors to scan for\n"
          "-Crel             Use relative con-/destructor function references\n"
+         "-cache <dir>      reuse identical link outputs from cache directory\n"
+         "-cachesize <val>  maximum size of the link cache (default 256MB)\n"
+         "-mapcsv <file>    write a machine-readable link map in CSV format\n"
          "-minalign <val>   Minimal section alignment (default 0)\n"
          "-baseoff <offset> offset for base relative relocations\n"
          "-N <old> <new>    Rename input sections\n"
@@ -86,10 +93,13 @@ void show_usage(void)
          "-os9-...=<val>    OS-9 options, refer to documentation\n"
          "-tos-flags <val>  sets TOS flags, refer to documentation\n"
          "-hunkattr <s>=<v> overwrite input section's memory attributes\n"
+         "-hunkoverlay <l>  following files form an overlay node at level l\n"
          "-vicelabels       generate label mapping for the VICE debugger\n"
          "-shared           generate shared object\n"
          "-soname <name>    set real name of shared object\n"
          "-export-dynamic   export all global symbols as dynamic symbols\n"
+         "-combreloc        sort dynamic relocations, relative ones first\n"
+         "-relr             sort and pack relative dynamic relocations\n"
          "-osec             output each section as an individual file\n"
          "-Rstd             standard relocation table\n"
          "-Radd             relocation table with addends\n"
@@ -97,20 +107,27 @@ void show_usage(void)
          "-Z                keep trailing zero-bytes in executables\n"
          "-d                force allocation of common symbols (also -dc,-dp)\n"
          "-da               force allocation of address symbols (PowerOpen)\n"
+         "-debugfile <file> write debug information into a separate file\n"
          "-sc               merge all code sections\n"
-         "-sd               merge all data and bss sections\n"
+         "-sd               merge all data and bss sections\n");
+  printf("-sdrefs           list small data candidates in the map file\n"
          "-mrel             merge sections with pc-relative references\n"
          "-mtype            merge all sections with the same type\n"
          "-mall             merge all sections to a single output section\n"
          "-m                enable feature-mask in symbol names\n"
          "-M                print segment mappings and symbol values\n"
          "-k                keep original section order\n"
+         "-pack             order sections by alignment to reduce padding\n"
+         "-symorder <file>  order code sections by symbols or call counts\n"
+         "-callgraph        order code sections by their references\n"
          "-n                no page alignment\n"
+         "-hugepages        align ELF segments to 2MB huge pages\n"
          "-q                keep relocations in the final executable\n"
          "-r                generate relocatable object\n"
          "-s                strip all symbols\n"
          "-S                strip debugging symbols only\n"
          "-t                trace file accesses by the linker\n"
+         "-time             print time spent in each link phase\n"
          "-x                discard all local symbols\n"
          "-X                discard temporary local symbols\n"
          "-w                suppress warnings\n"
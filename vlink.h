@@ -69,6 +69,7 @@ typedef int bool;
 
 #define MAXLEN 256		/* maximum length for symbols and buffers */
 #define FNAMEBUFSIZE 1024       /* buffer size for file names */
+#define MAPBUFSIZE 0x10000      /* output buffer size for the map file */
 #define MAX_FWALIGN 8192        /* max. alignment, when writing target file */
 
 /* macros */
@@ -172,11 +173,6 @@ struct ObjectUnit {
 #define OUF_SCRIPT 0x8000       /* linker script dummy object */
 #define OBJSYMHTABSIZE 0x20     /* number of entries in symbol hash table */
 
-struct RelRef {
-  struct RelRef *next;
-  struct Section *refsec;       /* relative referenced sections */
-};
-
 struct TargetExt {
   struct TargetExt *next;
   uint8_t id;                   /* target identification */
@@ -209,10 +205,12 @@ struct Section {
   unsigned long last_reloc;	/* offset to location behind last reloc/xref */
   struct list relocs;           /* relocations for this section */
   struct list xrefs;            /* external references to unknown symbols */
-  struct RelRef *relrefs;       /* all sections which are referenced rel. */
+  struct Section *relgroup;     /* group of sections with rel. references */
+  struct LinkedSection *grouplnk; /* group's LinkedSection (root only) */
   struct TargetExt *special;    /* link to target specific data */
   int link;                     /* link to other section (e.g. ELF-strtab) */
   uint16_t filldata;            /* used to fill gaps */
+  uint32_t order;               /* rank in code ordering, 0 is unordered */
 };
 
 /* section types */
@@ -298,6 +296,8 @@ struct Reloc {                  /* relocation information */
 #define R_SD21 33               /* PPC-EABI: SD for base-reg 0, 2 or 13 */
 #define R_MOSDREL 34            /* PPC-MOS: baserel(r13) rel. to __r13_init */
 #define R_AOSBREL 35            /* PPC-OS4: baserel(r2) rel. to data segm. */
+#define R_GOTPCX 36             /* x86_64: relaxable pc-rel. GOT reloc. */
+#define R_GOTPCXREX 37          /* x86_64: R_GOTPCX with REX prefix */
 
 /* internal relocation types */
 #define R_ABSCOPY 128           /* absolute sh.obj. ref., needs R_COPY */
@@ -372,6 +372,12 @@ struct SymNames {
   lword value;                  /* optional value */
 };
 
+struct SortKey {                /* array element for radix_sort() */
+  uint64_t key;                 /* offset or address */
+  void *ptr;                    /* Reloc, Symbol, etc. */
+};
+#define RADIXMIN 32             /* smaller arrays use an insertion sort */
+
 
 struct StabDebug {
   struct node n;
@@ -430,6 +436,7 @@ struct LinkedSection {          /* linked sections of same type and name */
   unsigned long size;           /* the section's size in bytes */
   unsigned long filesize;       /* size in file, rest is filled with '0' */
   unsigned long gapsize;        /* bytes to fill until next section */
+  unsigned long joinstamp;      /* last modification in merge_seclist() */
   struct list sections;         /* s. which have been linked together */
   uint8_t *data;                /* the section's contents */
   struct list relocs;           /* relocations for this section */
@@ -441,6 +448,7 @@ struct LinkedSection {          /* linked sections of same type and name */
 #define LSF_USED           0x01 /* section used in linker script */
 #define LSF_NOLOAD         0x02 /* used on empty LinkedSection (ldscript) */
 #define LSF_PRESERVE       0x04 /* don't delete when unused/empty */
+#define LSF_PLACED         0x08 /* final address was assigned */
 
 
 struct Phdr {
@@ -468,9 +476,12 @@ struct Phdr {
 #define PHDR_USED       0x0010  /* this program header is used for output */
 #define PHDR_PFMASK     0x000f  /* mask for seg. permissions "PF_?" */
 
+#define HUGEPAGE_ALIGN  21      /* 2MB segment alignment for -hugepages */
+
 
 /* Global defines */
 #define DEF_MAXERRORS 999999    /* don't want this feature now... */
+#define DEF_CACHELIMIT 0x10000000 /* 256MB default size of link cache */
 #define STRIP_NONE 0
 #define STRIP_DEBUG 1           /* strip debugger symbols only */
 #define STRIP_ALL 2             /* strip all symbols */
@@ -497,10 +508,13 @@ struct GlobalVars {
   uint8_t strip_symbols;        /* strip symbols */
   uint8_t discard_local;        /* discard local symbols */
   uint8_t reloctab_format;      /* format of relocation table (.rel/.rela) */
+  uint8_t dynreloc_format;      /* order and packing of dynamic relocations */
   bool small_code;              /* combine all code sections */
   bool small_data;              /* combine all data sections */
+  bool sd_report;               /* report small data candidates in map */
   bool multibase;               /* don't merge all base-rel. accessed sect.*/
   bool no_page_align;           /* page-alignment disabled */
+  bool huge_pages;              /* align segments to huge pages */
   bool fix_unnamed;             /* unnamed section get a default name */
   bool textbaserel;             /* allow base-relative access on code secs. */
   bool textbasedsyms;           /* symbol offsets based on text section */
@@ -513,14 +527,22 @@ struct GlobalVars {
   uint8_t gc_sects;             /* garbage-collect unreferenced sections */
   bool keep_trailing_zeros;     /* keep trailing zero-bytes at end of sect. */
   bool keep_sect_order;         /* keep order of section as found in objs */
+  bool pack_sections;           /* order sections by alignment */
+  bool callgraph_order;         /* order code sections by their references */
   uint8_t bits_per_tbyte;       /* bits per target byte (word) */
   uint8_t bits_per_taddr;       /* bits in target address (taddr, lword) */
   uint8_t tbytes_per_taddr;     /* target bytes in a target address word */
   char masked_symbols;          /* symbols may use a feature-mask */
   bool fail_on_warning;         /* return with error code from warnings */
+  bool phase_times;             /* print time spent in each link phase */
   FILE *map_file;               /* map file */
+  const char *map_name;         /* map file name, NULL for stdout */
+  const char *debug_name;       /* companion file with debug information */
   FILE *trace_file;             /* linker trace output */
   FILE *vice_file;              /* label-file for the VICE emulator */
+  FILE *csvmap_file;            /* machine-readable map file (CSV) */
+  const char *cache_dir;        /* link output cache directory */
+  unsigned long cache_limit;    /* maximum size of the cache in bytes */
   struct SymNames **trace_syms; /* trace-symbol hash table */
   struct SymNames *prot_syms;   /* list of protected symbols */
   struct SymNames *undef_syms;  /* list of undefined symbols */
@@ -529,6 +551,8 @@ struct GlobalVars {
   struct SecRename *secrenames; /* input section renaming */
   const char *scriptname;
   const char *ldscript;         /* linker-script to be used for output file */
+  const char *symorder_name;
+  const char *symorder;         /* symbol ordering file for code sections */
   const char *entry_name;       /* entry point symbol or addr (-e option) */
   lword start_addr;             /* -Ttext sets base address of first sect. */
   const char *soname;           /* real name of shared object (-soname) */
@@ -555,6 +579,7 @@ struct GlobalVars {
   struct list pripointers;      /* list of PriPointer nodes */
   struct list lnksec;           /* list of linked sections */
   int nsecs;                    /* total number of sections in lnksec */
+  bool lnksec_sorted;           /* lnksec sorted by LMA (load_next_section) */
   struct ObjectUnit *dynobj;    /* artif. object for dynamic sections */
   struct LinkedSection *firstSD;/* first small data section */
   struct Section *dummysec;     /* contains nothing, has base addr. 0 */
@@ -598,6 +623,11 @@ struct GlobalVars {
 #define RTAB_ADDEND     0x02    /* table includes addends */
 #define RTAB_SHORTOFF   0x04    /* table uses short offsets (e.g. 16 bit) */
 
+/* dynreloc_format */
+#define DYNREL_UNSORTED 0       /* dynamic relocations in order of creation */
+#define DYNREL_SORTED   1       /* relative relocations first, then by symbol */
+#define DYNREL_RELR     2       /* sorted, relative relocations packed (RELR) */
+
 /* script flags */
 #define LDSF_KEEP     0x01      /* don't delete empty sections */
 #define LDSF_SORTFIL  0x02      /* sort files machting on pattern */
@@ -667,6 +697,12 @@ struct FFFuncs {                /* file format specific functions and data */
   int8_t addr_bits;             /* bits in a target address (16, 32, 64) */
   uint8_t ptr_alignment;        /* minimum alignment for pointers */
   uint32_t flags;               /* general and target-family specific flags */
+  bool                          /* create stub for out-of-range branch */
+    (*farcall)(struct GlobalVars *,struct Section *,struct Reloc *);
+  void                          /* write output image without debug info */
+    (*splitdebug)(struct GlobalVars *,FILE *,uint8_t *,unsigned long);
+  bool                          /* turn GOT ref. into a direct reference */
+    (*gotrelax)(struct GlobalVars *,struct Section *,struct Reloc *);
 };
 
 /* Init modes */
@@ -715,6 +751,13 @@ struct FFFuncs {                /* file format specific functions and data */
                                 /* each section. */
 #define FFF_NOFILE 0x20         /* Target creates output files itself */
 #define FFF_KEEPRELOCS 0x40     /* Binary target allows reloc table appended */
+#define FFF_EXTRAFILES 0x80     /* Target writes more files than the output */
+#define FFF_IDMASK 0x0f00       /* Class of input files, recognized by a */
+                                /* magic id before calling identify() */
+#define FFF_ID_ELF 0x0100
+#define FFF_ID_AOUT 0x0200
+#define FFF_ID_HUNK 0x0300
+#define FFF_ID_VOBJ 0x0400
 
 
 /* List of artificially generated pointers or long words, which are */
@@ -726,6 +769,8 @@ struct PriPointer {
   int priority;
   const char *xrefname;
   lword addend;
+  struct ObjectUnit *obj;       /* defining object, for error messages */
+  unsigned long seq;            /* order of insertion, for stable sorting */
 };
 
 
@@ -743,6 +788,7 @@ void cleanup(struct GlobalVars *);
 /* version.c */
 #ifndef VERSION_C
 extern const char *version_str;
+extern const char *build_date;
 #endif
 void show_version(void);
 void show_usage(void);
@@ -813,6 +859,7 @@ int lshiftcnt(lword);
 int highest_bit_set(lword);
 lword sign_extend(lword,int);
 void add_symnames(struct SymNames **,const char *,lword);
+void radix_sort(struct SortKey *,unsigned long);
 
 #define listempty(x) ((x)->first->next==NULL)
 #define makemask(x) ((lword)(1LL<<(x))-1)
@@ -845,6 +892,7 @@ const char *getobjname(struct ObjectUnit *);
 void print_function_name(struct Section *,unsigned long);
 void print_symbol(struct GlobalVars *,FILE *,struct Symbol *);
 bool trace_sym_access(struct GlobalVars *,const char *);
+void symcache_invalidate(const char *);
 
 /* targets.c */
 #ifndef TARGETS_C
@@ -887,6 +935,8 @@ struct Symbol *findlocsymbol(struct GlobalVars *,struct ObjectUnit *,
                              const char *);
 void addlocsymbol(struct GlobalVars *,struct Section *,char *,char *,
                   lword,uint8_t,uint8_t,uint8_t,uint32_t);
+struct Symbol *adduniqsymbol(struct GlobalVars *,struct Section *,
+                             const char *,lword,uint8_t,uint8_t,uint32_t);
 bool addglobsym(struct GlobalVars *,struct Symbol *);
 struct Symbol *addlnksymbol(struct GlobalVars *,const char *,lword,
                             uint8_t,uint8_t,uint8_t,uint8_t,uint32_t);
@@ -902,6 +952,7 @@ struct RelocInsert *initRelocInsert(struct RelocInsert *,
 struct Reloc *newreloc(struct GlobalVars *,struct Section *,
                        const char *,struct Section *,uint32_t,
                        unsigned long,uint8_t,lword);
+struct Reloc *stubreloc(struct Reloc *,unsigned long,lword);
 void addreloc(struct Section *,struct Reloc *,uint16_t,uint16_t,lword);
 void addreloc_ri(struct Section *,struct Reloc *,struct RelocInsert *);
 bool isstdreloc(struct Reloc *,uint8_t,uint16_t);
@@ -915,6 +966,7 @@ bool checktargetext(struct LinkedSection *,uint8_t,uint8_t);
 lword readsection(struct GlobalVars *,uint8_t,uint8_t *,size_t,
                   struct RelocInsert *);
 lword writesection(struct GlobalVars *,uint8_t *,size_t,struct Reloc *,lword);
+bool checkreloc(struct Reloc *,lword);
 int writetaddr(struct GlobalVars *,void *,size_t,lword);
 void calc_relocs(struct GlobalVars *,struct LinkedSection *);
 void sort_relocs(struct list *);
@@ -966,6 +1018,13 @@ char *open_dir(const char *);
 char *read_dir(char *);
 void close_dir(char *);
 void set_exec(const char *);
+bool file_info(const char *,unsigned long *,unsigned long *);
+void touch_file(const char *);
+unsigned long process_id(void);
+
+/* cache.c */
+bool cache_fetch(struct GlobalVars *,int,const char **);
+void cache_store(struct GlobalVars *);
 
 /* ldscript.c */
 bool is_ld_script(struct ObjectUnit *);